@@ -2,11 +2,35 @@
 #include <iomanip>
 #include <vector>
 #include <string>
-#include <regex>
+#include <string_view>
 #include <ctime>
 #include <optional>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <unordered_map>
+#include <map>
+#include <set>
+#include <list>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <cstdint>
+#include <climits>
+#include <array>
+#include <tuple>
+#include <utility>
+#include <type_traits>
 #include <sqlite3.h>
 #include <windows.h>
+#include "Parse.h"
 
 using namespace std;
 
@@ -17,34 +41,39 @@ struct Ui {
 
 struct Filter { string in, out; int guests; };
 
-struct Date { int day, month, year; };
+struct FlexibleFilter { string from, to; int nights, guests; };
 
-namespace date {
-    bool is_year_leap(int year) { return (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0); }
-    optional<Date> parse_date(const string& date) {
-        static const regex date_regex(R"(^(\d{4})\D([1-9]|0[1-9]|1[0-2])\D([1-9]|0[1-9]|[12][0-9]|3[01])$)");
-        smatch matched_dates;
-        if (!regex_match(date, matched_dates, date_regex)) {
-            cerr << "Ошибка ввода! \n";
-            return nullopt;
-        }
+struct ReportRow { string status; int count; double amount; };
 
-        int year = stoi(matched_dates[1]); int month = stoi(matched_dates[2]); int day = stoi(matched_dates[3]);
+struct MonthReportRow { int month; string status; int count; double amount; };
 
-        if (year < 2001 || year > 2099) {
-            cerr << "Дата должна быть в диапазоне 2001 - 2099! \n";
-            return nullopt;
-        }
+struct ReportResult { Filter range; vector<ReportRow> rows; };
 
-        vector <int> days_in_month = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
-        if (is_year_leap(year)) { days_in_month[1] = 29; }
+struct AnalyticsRow { int type_id; string in, out; int guests; double price; string status; optional<string> booked_on; };
 
-        if (day > days_in_month[month - 1]) {
-            cerr << "Вы вышли за пределы месяца! \n";
-            return nullopt;
-        }
+struct RoomInventory { int type_id; string name; int rooms; };
+
+struct AnalyticsFilter { int from, to; bool paid_only; };
+
+struct RevenueCell { long long available, sold, guest_nights; double revenue; };
+
+struct AnalyticsReport {
+    AnalyticsFilter filter;
+    vector<string> types;
+    vector<array<RevenueCell, 7>> cells;
+    array<long long, 5> lead_time;
+    array<long long, 6> length_of_stay;
+};
 
-        return Date{ day, month, year };
+enum ReportState { REPORT_QUEUED, REPORT_RUNNING, REPORT_DONE, REPORT_CANCELLED, REPORT_FAILED };
+
+struct ReportProgress { ReportState state; int completed, total; };
+
+namespace date {
+    optional<Date> parse_date(string_view date) {
+        auto parsed = parse::date(date);
+        if (!parsed) return nullopt;
+        return parsed.value;
     }
     time_t to_time_t(const Date& date) {
         struct tm tm_date = { 0 };
@@ -70,6 +99,28 @@ namespace date {
         return result;
     }
     int days_between_dates(const Date& in, const Date& out) { return difftime(to_time_t(out), to_time_t(in)) / 86400; }
+    int to_days(const Date& date) {
+        int year = date.year - (date.month <= 2);
+        int era = year / 400, year_of_era = year - era * 400;
+        int day_of_year = (153 * (date.month + (date.month > 2 ? -3 : 9)) + 2) / 5 + date.day - 1;
+        int day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+        return era * 146097 + day_of_era - 719468;
+    }
+    optional<int> to_days(string_view str) {
+        auto parsed = parse_date(str);
+        if (parsed == nullopt) return nullopt;
+        return to_days(parsed.value());
+    }
+    Date from_days(int days) {
+        days += 719468;
+        int era = days / 146097, day_of_era = days - era * 146097;
+        int year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+        int day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+        int mp = (5 * day_of_year + 2) / 153;
+        int day = day_of_year - (153 * mp + 2) / 5 + 1;
+        int month = mp < 10 ? mp + 3 : mp - 9;
+        return Date{ day, month, year_of_era + era * 400 + (month <= 2) };
+    }
     string to_str(const Date& date) {
         string year = to_string(date.year), month = to_string(date.month), day = to_string(date.day);
         if (month.size() < 2) month = '0' + month;
@@ -82,9 +133,9 @@ namespace date {
         while (true) {
             cout << "Введите дату в формате (ГГГГ-ММ-ДД): ";
             cin >> input;
-            auto new_date = parse_date(input);
-            if (new_date == nullopt) continue;
-            return new_date.value();
+            auto new_date = parse::date(input);
+            if (new_date) return new_date.value;
+            cerr << parse::describe(new_date.error);
         }
     }
 }
@@ -132,34 +183,984 @@ public:
 
 enum ReservationStatus { NOT_STARTED, ACTIVE, OVER };
 
+enum BulkOperation { CONFIRM_PAYMENT, CANCEL_RESERVATION };
+
+enum BulkOutcome { BULK_DONE, BULK_NOT_FOUND, BULK_FAILED };
+
+struct BookingPredicate { optional<int> user_id; optional<Filter> dates; };
+
+enum TableName { USERS, ROOMS, ROOM_TYPES, BOOKINGS, CHANGE_LOG, OTHER_TABLE };
+
+struct ChangeEvent { TableName table; int operation; sqlite3_int64 row_id; };
+
+struct LoggedChange { sqlite3_int64 seq; TableName table; sqlite3_int64 row_id; };
+
+TableName table_by_name(const char* table) {
+    string name = table ? table : "";
+    if (name == "users") return USERS;
+    if (name == "rooms") return ROOMS;
+    if (name == "room_types") return ROOM_TYPES;
+    if (name == "bookings") return BOOKINGS;
+    if (name == "change_log") return CHANGE_LOG;
+    return OTHER_TABLE;
+}
+
+struct ChangeBatch {
+    vector<ChangeEvent> events;
+    bool external = false;
+    bool touches(TableName table) const {
+        if (external) return true;
+        for (const auto& event : events) if (event.table == table) return true;
+        return false;
+    }
+};
+
+template <typename T>
+class LockFreeQueue {
+    struct Cell { atomic<size_t> sequence; T data; };
+    unique_ptr<Cell[]> buffer;
+    size_t mask;
+    alignas(64) atomic<size_t> enqueue_pos{ 0 };
+    alignas(64) atomic<size_t> dequeue_pos{ 0 };
+public:
+    explicit LockFreeQueue(size_t capacity) : buffer(new Cell[capacity]), mask(capacity - 1) {
+        for (size_t i = 0; i < capacity; i++) buffer[i].sequence.store(i, memory_order_relaxed);
+    }
+    bool push(T value) {
+        size_t pos = enqueue_pos.load(memory_order_relaxed);
+        while (true) {
+            Cell& cell = buffer[pos & mask];
+            size_t seq = cell.sequence.load(memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    cell.data = move(value);
+                    cell.sequence.store(pos + 1, memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) return false;
+            else pos = enqueue_pos.load(memory_order_relaxed);
+        }
+    }
+    optional<T> pop() {
+        size_t pos = dequeue_pos.load(memory_order_relaxed);
+        while (true) {
+            Cell& cell = buffer[pos & mask];
+            size_t seq = cell.sequence.load(memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    T value = move(cell.data);
+                    cell.sequence.store(pos + mask + 1, memory_order_release);
+                    return value;
+                }
+            }
+            else if (diff < 0) return nullopt;
+            else pos = dequeue_pos.load(memory_order_relaxed);
+        }
+    }
+};
+
+constexpr int sql_placeholders(const char* sql) {
+    int count = 0;
+    bool quoted = false;
+    for (; *sql; sql++) {
+        if (*sql == '\'') quoted = !quoted;
+        else if (*sql == '?' && !quoted) {
+            int index = 0;
+            while (sql[1] >= '0' && sql[1] <= '9') index = index * 10 + (*++sql - '0');
+            count = index ? max(count, index) : count + 1;
+        }
+    }
+    return count;
+}
+
+constexpr size_t sql_length(const char* sql) {
+    size_t length = 0;
+    while (sql[length]) length++;
+    return length;
+}
+
+template <const char* Text>
+struct SqlLiteral { static constexpr const char* value = Text; };
+
+template <size_t N, typename... Parts>
+constexpr array<char, N> sql_concat() {
+    array<char, N> result{};
+    size_t pos = 0;
+    for (const char* part : { Parts::value... }) for (; *part; part++) result[pos++] = *part;
+    return result;
+}
+
+template <typename... Parts>
+struct SqlConcat {
+    static constexpr size_t length = (sql_length(Parts::value) + ...);
+    static constexpr array<char, length + 1> text = sql_concat<length + 1, Parts...>();
+    static constexpr const char* value = text.data();
+};
+
+template <typename T> struct Column;
+template <> struct Column<int> { static int read(sqlite3_stmt* stmt, int i) { return sqlite3_column_int(stmt, i); } };
+template <> struct Column<sqlite3_int64> { static sqlite3_int64 read(sqlite3_stmt* stmt, int i) { return sqlite3_column_int64(stmt, i); } };
+template <> struct Column<double> { static double read(sqlite3_stmt* stmt, int i) { return sqlite3_column_double(stmt, i); } };
+template <> struct Column<string> {
+    static string read(sqlite3_stmt* stmt, int i) {
+        const unsigned char* text = sqlite3_column_text(stmt, i);
+        return text ? reinterpret_cast<const char*>(text) : "";
+    }
+};
+template <> struct Column<TableName> { static TableName read(sqlite3_stmt* stmt, int i) { return table_by_name(Column<string>::read(stmt, i).c_str()); } };
+template <typename T> struct Column<optional<T>> {
+    static optional<T> read(sqlite3_stmt* stmt, int i) {
+        if (sqlite3_column_type(stmt, i) == SQLITE_NULL) return nullopt;
+        return Column<T>::read(stmt, i);
+    }
+};
+
+template <typename T, typename... Columns> struct RowOf {};
+
+template <typename Result>
+struct RowDecoder {
+    using type = Result;
+    static Result read(sqlite3_stmt* stmt) { return Column<Result>::read(stmt, 0); }
+};
+template <typename T, typename... Columns>
+struct RowDecoder<RowOf<T, Columns...>> {
+    using type = T;
+    template <size_t... I>
+    static T read(sqlite3_stmt* stmt, index_sequence<I...>) { return T{ Column<Columns>::read(stmt, static_cast<int>(I))... }; }
+    static T read(sqlite3_stmt* stmt) { return read(stmt, index_sequence_for<Columns...>{}); }
+};
+
+using ReservationRow = RowOf<Reservation, int, int, int, int, string, string, double, string>;
+using RoomRow = RowOf<Room, int, string, int, double>;
+using UserRow = RowOf<User, int, string, string, string, string>;
+
+inline void bind_value(sqlite3_stmt* stmt, int i, int value) { sqlite3_bind_int(stmt, i, value); }
+inline void bind_value(sqlite3_stmt* stmt, int i, sqlite3_int64 value) { sqlite3_bind_int64(stmt, i, value); }
+inline void bind_value(sqlite3_stmt* stmt, int i, double value) { sqlite3_bind_double(stmt, i, value); }
+inline void bind_value(sqlite3_stmt* stmt, int i, const string& value) { sqlite3_bind_text(stmt, i, value.c_str(), -1, SQLITE_TRANSIENT); }
+template <typename T>
+void bind_value(sqlite3_stmt* stmt, int i, const optional<T>& value) {
+    if (value) bind_value(stmt, i, value.value());
+    else sqlite3_bind_null(stmt, i);
+}
+
+template <typename Sql, typename Result, typename... Params>
+struct Query {
+    static constexpr const char* sql = Sql::value;
+    static_assert(sql_placeholders(Sql::value) == sizeof...(Params), "Количество параметров запроса не совпадает с SQL");
+    using row = Result;
+
+    template <typename... Args>
+    static void bind([[maybe_unused]] sqlite3_stmt* stmt, const Args&... args) {
+        static_assert(sizeof...(Args) == sizeof...(Params), "Неверное количество аргументов запроса");
+        static_assert((is_convertible_v<const Args&, Params> && ...), "Неверный тип аргумента запроса");
+        [[maybe_unused]] int index = 0;
+        (bind_value(stmt, ++index, static_cast<const Params&>(args)), ...);
+    }
+};
+
+class StatementCache {
+    sqlite3* DB = nullptr;
+    unordered_map<const char*, vector<sqlite3_stmt*>> idle;
+public:
+    explicit StatementCache(sqlite3* connection = nullptr) : DB(connection) {}
+    ~StatementCache() { clear(); }
+    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    sqlite3* connection() const { return DB; }
+    void attach(sqlite3* connection) {
+        clear();
+        DB = connection;
+    }
+    sqlite3_stmt* acquire(const char* sql) {
+        auto& statements = idle[sql];
+        if (!statements.empty()) {
+            sqlite3_stmt* stmt = statements.back();
+            statements.pop_back();
+            return stmt;
+        }
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v3(DB, sql, -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr) != SQLITE_OK) {
+            cerr << "Ошибка подготовки запроса: " << sqlite3_errmsg(DB) << "\n";
+            if (stmt) sqlite3_finalize(stmt);
+            return nullptr;
+        }
+        return stmt;
+    }
+    void release(const char* sql, sqlite3_stmt* stmt) {
+        if (!stmt) return;
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+        idle[sql].push_back(stmt);
+    }
+    void clear() {
+        for (auto& statements : idle) for (auto stmt : statements.second) sqlite3_finalize(stmt);
+        idle.clear();
+    }
+};
+
+template <typename Q>
+class Statement {
+    using Row = typename RowDecoder<typename Q::row>::type;
+    StatementCache& cache;
+    sqlite3_stmt* stmt;
+    int code = SQLITE_OK;
+public:
+    explicit Statement(StatementCache& statements) : cache(statements), stmt(statements.acquire(Q::sql)) {}
+    ~Statement() { cache.release(Q::sql, stmt); }
+    Statement(const Statement&) = delete;
+    Statement& operator=(const Statement&) = delete;
+
+    bool ok() const { return stmt != nullptr && (code == SQLITE_OK || code == SQLITE_ROW || code == SQLITE_DONE); }
+    template <typename... Args>
+    Statement& bind(const Args&... args) {
+        if (!stmt) return *this;
+        sqlite3_reset(stmt);
+        code = SQLITE_OK;
+        Q::bind(stmt, args...);
+        return *this;
+    }
+    bool execute() {
+        if (!stmt) return false;
+        code = sqlite3_step(stmt);
+        return code == SQLITE_DONE;
+    }
+    optional<Row> next() {
+        if (!stmt) return nullopt;
+        code = sqlite3_step(stmt);
+        if (code != SQLITE_ROW) return nullopt;
+        return RowDecoder<typename Q::row>::read(stmt);
+    }
+    vector<Row> all() {
+        vector<Row> rows;
+        while (auto row = next()) rows.push_back(move(row.value()));
+        return rows;
+    }
+};
+
+namespace queries {
+    inline constexpr char data_version[] = "PRAGMA data_version;";
+    inline constexpr char user_id_by_login[] = "SELECT user_id FROM users WHERE login = ?;";
+    inline constexpr char user_id_by_credentials[] = "SELECT user_id FROM users WHERE login = ? AND password = ?;";
+    inline constexpr char insert_user[] = "INSERT INTO users (login, password, name, surname, phone, email) VALUES (?, ?, ?, ?, ?, ?);";
+    inline constexpr char all_logins[] = "SELECT login FROM users;";
+    inline constexpr char login_by_id[] = "SELECT login FROM users WHERE user_id = ?;";
+    inline constexpr char user_by_id[] = "SELECT user_id, login, name, surname, role FROM users WHERE user_id = ?;";
+    inline constexpr char insert_booking[] = R"(
+        INSERT INTO bookings (user_id, room_id, guests_num, date_in, date_out, status, booked_on)
+        VALUES (?, ?, ?, ?, ?, ?, DATE('now', 'localtime'));)";
+    inline constexpr char rooms[] = R"(
+        SELECT r.room_id, rt.name, r.capacity, r.price
+        FROM rooms AS r
+        JOIN room_types AS rt ON r.type_id = rt.type_id)";
+    inline constexpr char free_rooms[] = R"(
+        WHERE NOT EXISTS (
+            SELECT 1
+            FROM bookings AS b
+            WHERE b.room_id = r.room_id
+                AND b.date_out > ?
+                AND b.date_in < ?
+        )
+        AND r.capacity >= ?)";
+    inline constexpr char order_rooms[] = " ORDER BY r.type_id, r.capacity, r.room_id;";
+    inline constexpr char room_type[] = "SELECT rt.name FROM room_types AS rt JOIN rooms AS r ON rt.type_id = r.type_id WHERE room_id = ?;";
+    inline constexpr char reservations[] = R"(
+        SELECT b.booking_id, b.user_id, b.room_id, b.guests_num, b.date_in, b.date_out, r.price * (JULIANDAY(b.date_out) - JULIANDAY(b.date_in)), b.status
+        FROM bookings AS b JOIN rooms AS r ON b.room_id = r.room_id)";
+    inline constexpr char by_booking_id[] = " WHERE b.booking_id = ?;";
+    inline constexpr char by_details[] = R"(
+        JOIN users AS u ON b.user_id = u.user_id
+        WHERE u.surname = ? OR u.phone = ? OR u.email = ?)";
+    inline constexpr char where[] = " WHERE";
+    inline constexpr char by_guest[] = " b.user_id = ? AND";
+    inline constexpr char not_started[] = " JULIANDAY(b.date_in) > JULIANDAY('NOW')";
+    inline constexpr char active[] = " JULIANDAY('NOW') BETWEEN JULIANDAY(b.date_in) AND JULIANDAY(b.date_out)";
+    inline constexpr char over[] = " JULIANDAY(b.date_out) < JULIANDAY('NOW')";
+    inline constexpr char order_reservations[] = " ORDER BY b.date_in ASC;";
+    inline constexpr char end[] = ";";
+    inline constexpr char confirm_payment[] = "UPDATE bookings SET status = 'paid' WHERE booking_id = ?;";
+    inline constexpr char delete_booking[] = "DELETE FROM bookings WHERE booking_id = ?;";
+    inline constexpr char booking_ids[] = R"(
+        SELECT booking_id FROM bookings
+        WHERE (?1 IS NULL OR user_id = ?1) AND (?2 IS NULL OR date_in >= ?2) AND (?3 IS NULL OR date_out <= ?3)
+        ORDER BY date_in ASC;)";
+    inline constexpr char change_seq[] = "SELECT seq FROM sqlite_sequence WHERE name = 'change_log';";
+    inline constexpr char first_change_seq[] = "SELECT MIN(seq) FROM change_log;";
+    inline constexpr char changes_since[] = "SELECT seq, table_name, row_id FROM change_log WHERE seq > ? ORDER BY seq;";
+    inline constexpr char prune_changes[] = "DELETE FROM change_log WHERE seq <= ?;";
+    inline constexpr char report_by_status[] = R"(
+        SELECT
+            b.status,
+            COUNT(b.booking_id),
+            SUM(r.price * (JULIANDAY(b.date_out) - JULIANDAY(b.date_in)))
+        FROM
+            bookings AS b
+        JOIN rooms AS r ON b.room_id = r.room_id
+        WHERE b.date_in >= ? AND b.date_out <= ?
+        GROUP BY b.status;)";
+    inline constexpr char report_by_month[] = R"(
+        SELECT
+            CAST(STRFTIME('%m', b.date_in) AS INTEGER),
+            b.status,
+            COUNT(b.booking_id),
+            SUM(r.price * (JULIANDAY(b.date_out) - JULIANDAY(b.date_in)))
+        FROM
+            bookings AS b
+        JOIN rooms AS r ON b.room_id = r.room_id
+        WHERE b.date_in >= ? AND b.date_in <= ?
+        GROUP BY 1, b.status;)";
+
+    inline constexpr char auto_vacuum[] = "PRAGMA auto_vacuum;";
+    inline constexpr char free_pages[] = "PRAGMA freelist_count;";
+    inline constexpr char booking_columns[] = "SELECT name FROM pragma_table_info('bookings');";
+    inline constexpr char analytics_bookings[] = R"(
+        SELECT r.type_id, b.date_in, b.date_out, b.guests_num, r.price, b.status, b.booked_on
+        FROM bookings AS b JOIN rooms AS r ON b.room_id = r.room_id;)";
+    inline constexpr char room_inventory[] = R"(
+        SELECT rt.type_id, rt.name, COUNT(r.room_id)
+        FROM room_types AS rt LEFT JOIN rooms AS r ON r.type_id = rt.type_id
+        GROUP BY rt.type_id
+        ORDER BY rt.type_id;)";
+
+    template <const char* Text> using Sql = SqlLiteral<Text>;
+
+    using DataVersion = Query<Sql<data_version>, int>;
+    using UserIdByLogin = Query<Sql<user_id_by_login>, int, string>;
+    using UserIdByCredentials = Query<Sql<user_id_by_credentials>, int, string, string>;
+    using InsertUser = Query<Sql<insert_user>, void, string, string, string, string, string, string>;
+    using UserById = Query<Sql<user_by_id>, UserRow, int>;
+    using AllLogins = Query<Sql<all_logins>, string>;
+    using LoginById = Query<Sql<login_by_id>, string, sqlite3_int64>;
+    using InsertBooking = Query<Sql<insert_booking>, void, int, int, int, string, string, string>;
+    using FreeRooms = Query<SqlConcat<Sql<rooms>, Sql<free_rooms>, Sql<order_rooms>>, RoomRow, string, string, int>;
+    using AllRooms = Query<SqlConcat<Sql<rooms>, Sql<order_rooms>>, RoomRow>;
+    using RoomType = Query<Sql<room_type>, string, int>;
+    using AllReservations = Query<SqlConcat<Sql<reservations>, Sql<end>>, ReservationRow>;
+    using ReservationById = Query<SqlConcat<Sql<reservations>, Sql<by_booking_id>>, ReservationRow, int>;
+    using ReservationsByDetails = Query<SqlConcat<Sql<reservations>, Sql<by_details>, Sql<order_reservations>>, ReservationRow, string, string, string>;
+    using ConfirmPayment = Query<Sql<confirm_payment>, void, int>;
+    using DeleteBooking = Query<Sql<delete_booking>, void, int>;
+    using BookingIds = Query<Sql<booking_ids>, int, optional<int>, optional<string>, optional<string>>;
+    using ChangeSeq = Query<Sql<change_seq>, sqlite3_int64>;
+    using FirstChangeSeq = Query<Sql<first_change_seq>, optional<sqlite3_int64>>;
+    using ChangesSince = Query<Sql<changes_since>, RowOf<LoggedChange, sqlite3_int64, TableName, sqlite3_int64>, sqlite3_int64>;
+    using PruneChanges = Query<Sql<prune_changes>, void, sqlite3_int64>;
+    using ReportByStatus = Query<Sql<report_by_status>, RowOf<ReportRow, string, int, double>, string, string>;
+    using ReportByMonth = Query<Sql<report_by_month>, RowOf<MonthReportRow, int, string, int, double>, string, string>;
+    using BookingColumns = Query<Sql<booking_columns>, string>;
+    using AutoVacuum = Query<Sql<auto_vacuum>, int>;
+    using FreePages = Query<Sql<free_pages>, int>;
+    using AnalyticsBookings = Query<Sql<analytics_bookings>, RowOf<AnalyticsRow, int, string, string, int, double, string, optional<string>>>;
+    using RoomInventoryByType = Query<Sql<room_inventory>, RowOf<RoomInventory, int, string, int>>;
+
+    template <ReservationStatus Status> struct StatusCondition;
+    template <> struct StatusCondition<NOT_STARTED> : Sql<not_started> {};
+    template <> struct StatusCondition<ACTIVE> : Sql<active> {};
+    template <> struct StatusCondition<OVER> : Sql<over> {};
+
+    template <ReservationStatus Status>
+    using GuestReservationsByStatus = Query<SqlConcat<Sql<reservations>, Sql<where>, Sql<by_guest>, StatusCondition<Status>, Sql<order_reservations>>, ReservationRow, int>;
+    template <ReservationStatus Status>
+    using AllReservationsByStatus = Query<SqlConcat<Sql<reservations>, Sql<where>, StatusCondition<Status>, Sql<order_reservations>>, ReservationRow>;
+}
+
+class HoldTable {
+    struct Hold { int room_id, from, to; uint64_t expires; list<int>::iterator position; };
+    static constexpr size_t SLOTS = 1024;
+
+    mutex guard;
+    chrono::steady_clock::time_point origin = chrono::steady_clock::now();
+    uint64_t current_tick = 0;
+    vector<list<int>> wheel = vector<list<int>>(SLOTS);
+    unordered_map<int, Hold> holds;
+    unordered_map<int, vector<int>> room_holds;
+    int next_id = 1;
+
+    uint64_t now_tick() const { return chrono::duration_cast<chrono::seconds>(chrono::steady_clock::now() - origin).count(); }
+    void erase(int id) {
+        auto it = holds.find(id);
+        if (it == holds.end()) return;
+        wheel[it->second.expires % SLOTS].erase(it->second.position);
+        auto& ids = room_holds[it->second.room_id];
+        ids.erase(remove(ids.begin(), ids.end(), id), ids.end());
+        if (ids.empty()) room_holds.erase(it->second.room_id);
+        holds.erase(it);
+    }
+    void expire_slot(size_t slot, uint64_t now) {
+        for (auto it = wheel[slot].begin(); it != wheel[slot].end();) {
+            int id = *it++;
+            if (holds[id].expires <= now) erase(id);
+        }
+    }
+    void advance() {
+        uint64_t now = now_tick();
+        if (now - current_tick >= SLOTS) for (size_t slot = 0; slot < SLOTS; slot++) expire_slot(slot, now);
+        else for (uint64_t tick = current_tick + 1; tick <= now; tick++) expire_slot(tick % SLOTS, now);
+        current_tick = now;
+    }
+    bool overlaps(int room_id, int from, int to, int except = 0) {
+        auto it = room_holds.find(room_id);
+        if (it == room_holds.end()) return false;
+        for (int id : it->second) {
+            const Hold& hold = holds[id];
+            if (id != except && hold.from < to && hold.to > from) return true;
+        }
+        return false;
+    }
+public:
+    optional<int> acquire(int room_id, int from, int to, chrono::seconds ttl) {
+        lock_guard<mutex> lock(guard);
+        advance();
+        if (overlaps(room_id, from, to)) return nullopt;
+
+        int id = next_id++;
+        uint64_t expires = current_tick + max<uint64_t>(1, ttl.count());
+        auto& slot = wheel[expires % SLOTS];
+        slot.push_front(id);
+        holds[id] = Hold{ room_id, from, to, expires, slot.begin() };
+        room_holds[room_id].push_back(id);
+        return id;
+    }
+    bool is_active(int id) {
+        lock_guard<mutex> lock(guard);
+        advance();
+        return holds.count(id) > 0;
+    }
+    void release(int id) {
+        lock_guard<mutex> lock(guard);
+        erase(id);
+    }
+    bool is_held(int room_id, int from, int to) {
+        lock_guard<mutex> lock(guard);
+        advance();
+        return overlaps(room_id, from, to);
+    }
+    size_t size() {
+        lock_guard<mutex> lock(guard);
+        advance();
+        return holds.size();
+    }
+};
+
+struct StorageProfile {
+    string name = "balanced";
+    long long cache_size_kb = 32768;
+    long long mmap_size = 268435456;
+    string synchronous = "NORMAL";
+    string temp_store = "MEMORY";
+    long long maintenance_minutes = 30;
+    long long vacuum_pages = 256;
+
+    static optional<StorageProfile> by_name(const string& name) {
+        StorageProfile profile;
+        profile.name = name;
+        if (name == "durable") {
+            profile.cache_size_kb = 8192;
+            profile.mmap_size = 0;
+            profile.synchronous = "FULL";
+            profile.temp_store = "DEFAULT";
+        }
+        else if (name == "throughput") {
+            profile.cache_size_kb = 131072;
+            profile.mmap_size = 1073741824;
+            profile.maintenance_minutes = 60;
+            profile.vacuum_pages = 1024;
+        }
+        else if (name != "balanced") return nullopt;
+        return profile;
+    }
+    bool set(const string& key, const string& value) {
+        static const vector<string> synchronous_modes = { "OFF", "NORMAL", "FULL", "EXTRA" };
+        static const vector<string> temp_store_modes = { "DEFAULT", "FILE", "MEMORY" };
+
+        if (key == "profile") {
+            auto profile = by_name(value);
+            if (profile) *this = profile.value();
+            return profile.has_value();
+        }
+        if (key == "synchronous" || key == "temp_store") {
+            const auto& modes = key == "synchronous" ? synchronous_modes : temp_store_modes;
+            if (find(modes.begin(), modes.end(), value) == modes.end()) return false;
+            (key == "synchronous" ? synchronous : temp_store) = value;
+            return true;
+        }
+
+        long long* target = nullptr;
+        if (key == "cache_size_kb") target = &cache_size_kb;
+        else if (key == "mmap_size") target = &mmap_size;
+        else if (key == "maintenance_minutes") target = &maintenance_minutes;
+        else if (key == "vacuum_pages") target = &vacuum_pages;
+        if (!target || value.empty() || value.find_first_not_of("0123456789") != string::npos || value.size() > 15) return false;
+        *target = stoll(value);
+        return true;
+    }
+    string pragmas() const {
+        return "PRAGMA cache_size = -" + to_string(cache_size_kb) + "; PRAGMA mmap_size = " + to_string(mmap_size)
+            + "; PRAGMA synchronous = " + synchronous + "; PRAGMA temp_store = " + temp_store + ";";
+    }
+};
+
+StorageProfile load_storage_profile(int argc, char* argv[]) {
+    StorageProfile profile;
+    string config_path = "db/storage.conf";
+    vector<pair<string, string>> options, arguments;
+
+    for (int i = 1; i < argc; i++) {
+        string argument = argv[i];
+        size_t equals = argument.find('=');
+        if (argument.rfind("--", 0) != 0 || equals == string::npos) {
+            cerr << "Неизвестный параметр: " << argument << "\n";
+            continue;
+        }
+        string key = argument.substr(2, equals - 2), value = argument.substr(equals + 1);
+        if (key == "config") config_path = value;
+        else arguments.push_back({ key, value });
+    }
+
+    auto trim = [](const string& str) {
+        size_t first = str.find_first_not_of(" \t\r"), last = str.find_last_not_of(" \t\r");
+        return first == string::npos ? string() : str.substr(first, last - first + 1);
+    };
+    ifstream config(config_path);
+    string line;
+    while (getline(config, line)) {
+        line = line.substr(0, line.find('#'));
+        size_t equals = line.find('=');
+        if (equals != string::npos) options.push_back({ trim(line.substr(0, equals)), trim(line.substr(equals + 1)) });
+    }
+
+    options.insert(options.end(), arguments.begin(), arguments.end());
+    stable_partition(options.begin(), options.end(), [](const pair<string, string>& option) { return option.first == "profile"; });
+    for (const auto& option : options)
+        if (!profile.set(option.first, option.second)) cerr << "Неверный параметр хранилища: " << option.first << " = " << option.second << "\n";
+    return profile;
+}
+
+struct StorageStats { string profile; int cache_hits, cache_misses, cache_used, auto_vacuum, free_pages; };
+
+struct SearchCacheStats { long long hits, misses, invalidations, evictions; size_t entries; };
+
+class SearchCache {
+    using Key = tuple<string, string, int>;
+    struct Entry { int from, to; vector<Room> rooms; list<Key>::iterator recent; };
+
+    size_t capacity;
+    map<Key, Entry> entries;
+    list<Key> recency;
+    multimap<int, map<Key, Entry>::iterator> by_start;
+    int longest = 0;
+    SearchCacheStats stats{};
+
+    void erase(map<Key, Entry>::iterator entry) {
+        auto range = by_start.equal_range(entry->second.from);
+        for (auto it = range.first; it != range.second; it++) {
+            if (it->second == entry) {
+                by_start.erase(it);
+                break;
+            }
+        }
+        recency.erase(entry->second.recent);
+        entries.erase(entry);
+    }
+public:
+    explicit SearchCache(size_t max_entries = 256) : capacity(max_entries) {}
+
+    const vector<Room>* find(const Filter& filter) {
+        auto entry = entries.find({ filter.in, filter.out, filter.guests });
+        if (entry == entries.end()) {
+            stats.misses++;
+            return nullptr;
+        }
+        stats.hits++;
+        recency.splice(recency.begin(), recency, entry->second.recent);
+        return &entry->second.rooms;
+    }
+    const vector<Room>& store(const Filter& filter, int from, int to, vector<Room> rooms) {
+        Key key{ filter.in, filter.out, filter.guests };
+        auto existing = entries.find(key);
+        if (existing != entries.end()) erase(existing);
+        else if (entries.size() >= capacity) {
+            erase(entries.find(recency.back()));
+            stats.evictions++;
+        }
+
+        recency.push_front(key);
+        auto entry = entries.emplace(move(key), Entry{ from, to, move(rooms), recency.begin() }).first;
+        by_start.emplace(from, entry);
+        longest = max(longest, to - from);
+        return entry->second.rooms;
+    }
+    void invalidate(int from, int to) {
+        auto it = by_start.lower_bound(from - longest);
+        while (it != by_start.end() && it->first < to) {
+            auto entry = (it++)->second;
+            if (entry->second.to <= from) continue;
+            erase(entry);
+            stats.invalidations++;
+        }
+    }
+    void clear() {
+        stats.invalidations += entries.size();
+        entries.clear();
+        recency.clear();
+        by_start.clear();
+        longest = 0;
+    }
+    SearchCacheStats get_stats() const {
+        SearchCacheStats result = stats;
+        result.entries = entries.size();
+        return result;
+    }
+};
+
+class LoginIndex {
+    static constexpr int HASHES = 7;
+    vector<uint64_t> bloom;
+    size_t bloom_mask = 0;
+    vector<string> logins;
+
+    static pair<uint64_t, uint64_t> hashes(const string& login) {
+        uint64_t first = 14695981039346656037ULL;
+        for (unsigned char c : login) first = (first ^ c) * 1099511628211ULL;
+        uint64_t second = static_cast<uint64_t>(hash<string>{}(login)) | 1;
+        return { first, second };
+    }
+    void add_to_bloom(const string& login) {
+        auto hash = hashes(login);
+        for (int i = 0; i < HASHES; i++) {
+            size_t bit = (hash.first + i * hash.second) & bloom_mask;
+            bloom[bit >> 6] |= 1ULL << (bit & 63);
+        }
+    }
+    bool maybe_contains(const string& login) const {
+        auto hash = hashes(login);
+        for (int i = 0; i < HASHES; i++) {
+            size_t bit = (hash.first + i * hash.second) & bloom_mask;
+            if (!(bloom[bit >> 6] >> (bit & 63) & 1)) return false;
+        }
+        return true;
+    }
+    void rebuild_bloom() {
+        size_t bits = 1024;
+        while (bits < logins.size() * 16) bits <<= 1;
+        bloom.assign(bits / 64, 0);
+        bloom_mask = bits - 1;
+        for (const auto& login : logins) add_to_bloom(login);
+    }
+public:
+    void load(vector<string> all_logins) {
+        logins = move(all_logins);
+        sort(logins.begin(), logins.end());
+        logins.erase(unique(logins.begin(), logins.end()), logins.end());
+        rebuild_bloom();
+    }
+    void add(const string& login) {
+        auto it = lower_bound(logins.begin(), logins.end(), login);
+        if (it != logins.end() && *it == login) return;
+        logins.insert(it, login);
+        if (logins.size() * 8 > bloom_mask + 1) rebuild_bloom();
+        else add_to_bloom(login);
+    }
+    bool contains(const string& login) const {
+        if (!maybe_contains(login)) return false;
+        return binary_search(logins.begin(), logins.end(), login);
+    }
+    string generate_free(const string& base) const {
+        if (!contains(base)) return base;
+
+        long long max_suffix = 0;
+        for (auto it = lower_bound(logins.begin(), logins.end(), base); it != logins.end() && it->compare(0, base.size(), base) == 0; it++) {
+            string suffix = it->substr(base.size());
+            if (suffix.empty() || suffix.size() > 12 || suffix[0] == '0' || suffix.find_first_not_of("0123456789") != string::npos) continue;
+            max_suffix = max(max_suffix, stoll(suffix));
+        }
+        return base + to_string(max_suffix + 1);
+    }
+};
+
 class Database {
     sqlite3* DB = nullptr;
+    string db_path;
+    StorageProfile storage;
+    StatementCache statements;
+    HoldTable holds;
+    SearchCache searches;
+    vector<sqlite3_int64> handled_bookings;
+    LoginIndex logins;
+    vector<ChangeEvent> pending_changes, committed_changes;
+    LockFreeQueue<ChangeBatch> change_queue{ 256 };
+    atomic<bool> queue_overflow{ false };
+    vector<pair<int, function<void(const ChangeBatch&)>>> subscribers;
+    int next_subscriber_id = 1;
+    int data_version = 0;
+    sqlite3_int64 logged_seq = 0;
+
+    static void on_update(void* self, int operation, const char*, const char* table, sqlite3_int64 row_id) {
+        static_cast<Database*>(self)->pending_changes.push_back({ table_by_name(table), operation, row_id });
+    }
+    static int on_commit(void* self) {
+        auto db = static_cast<Database*>(self);
+        db->committed_changes.insert(db->committed_changes.end(), db->pending_changes.begin(), db->pending_changes.end());
+        db->pending_changes.clear();
+        return 0;
+    }
+    static void on_rollback(void* self) {
+        auto db = static_cast<Database*>(self);
+        db->pending_changes.clear();
+        db->committed_changes.clear();
+    }
+    void on_user_changes(const ChangeBatch& batch) {
+        bool reload = batch.external;
+        for (const auto& event : batch.events) {
+            if (event.table != USERS) continue;
+            if (event.operation == SQLITE_INSERT) {
+                Statement<queries::LoginById> query(statements);
+                if (auto login = query.bind(event.row_id).next()) logins.add(login.value());
+            }
+            else reload = true;
+        }
+        if (reload) load_logins();
+    }
+    void on_search_changes(const ChangeBatch& batch) {
+        bool reset = batch.external || batch.touches(ROOMS) || batch.touches(ROOM_TYPES);
+        for (const auto& event : batch.events) {
+            if (reset || event.table != BOOKINGS) continue;
+            auto handled = find(handled_bookings.begin(), handled_bookings.end(), event.row_id);
+            if (handled != handled_bookings.end()) handled_bookings.erase(handled);
+            else reset = true;
+        }
+        if (!reset) return;
+        searches.clear();
+        handled_bookings.clear();
+    }
+    void invalidate_searches(const string& in, const string& out) {
+        auto from = date::to_days(in), to = date::to_days(out);
+        if (from && to) searches.invalidate(from.value(), to.value());
+        else searches.clear();
+    }
+    void load_logins() {
+        Statement<queries::AllLogins> query(statements);
+        logins.load(query.bind().all());
+    }
+    int read_data_version() {
+        Statement<queries::DataVersion> query(statements);
+        return query.bind().next().value_or(0);
+    }
+    template <typename Q>
+    void apply_bulk(const vector<int>& ids, vector<pair<int, BulkOutcome>>& outcomes) {
+        Statement<Q> query(statements);
+        if (!query.ok()) return;
+        for (int id : ids) {
+            if (!query.bind(id).execute()) outcomes.push_back({ id, BULK_FAILED });
+            else outcomes.push_back({ id, sqlite3_changes(DB) > 0 ? BULK_DONE : BULK_NOT_FOUND });
+        }
+    }
+    vector<pair<int, BulkOutcome>> run_bulk(const function<vector<int>()>& select_ids, BulkOperation operation) {
+        vector<pair<int, BulkOutcome>> outcomes;
+        if (sqlite3_exec(DB, "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            cerr << "Ошибка начала транзакции: " << sqlite3_errmsg(DB) << "\n";
+            return outcomes;
+        }
+
+        vector<int> ids = select_ids();
+        unordered_map<int, Reservation> deleted;
+        if (operation == CONFIRM_PAYMENT) apply_bulk<queries::ConfirmPayment>(ids, outcomes);
+        else {
+            for (int id : ids) if (auto reservation = get_reservation_by_id(id)) deleted.emplace(id, reservation.value());
+            apply_bulk<queries::DeleteBooking>(ids, outcomes);
+        }
+
+        if (sqlite3_exec(DB, "COMMIT;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            cerr << "Ошибка при сохранении изменений: " << sqlite3_errmsg(DB) << "\n";
+            sqlite3_exec(DB, "ROLLBACK;", nullptr, nullptr, nullptr);
+            for (auto& outcome : outcomes) outcome.second = BULK_FAILED;
+        }
+        for (const auto& outcome : outcomes) {
+            if (outcome.second != BULK_DONE) continue;
+            handled_bookings.push_back(outcome.first);
+            auto reservation = deleted.find(outcome.first);
+            if (reservation != deleted.end()) invalidate_searches(reservation->second.get_in(), reservation->second.get_out());
+        }
+        poll_changes();
+        return outcomes;
+    }
+    int read_auto_vacuum() {
+        Statement<queries::AutoVacuum> query(statements);
+        return query.bind().next().value_or(0);
+    }
+    void enable_incremental_vacuum() {
+        if (read_auto_vacuum() != 0) return;
+        cout << "Перевод базы данных в режим инкрементальной очистки... \n";
+        if (sqlite3_exec(DB, "PRAGMA auto_vacuum = INCREMENTAL; VACUUM;", nullptr, nullptr, nullptr) != SQLITE_OK)
+            cerr << "Ошибка включения инкрементальной очистки: " << sqlite3_errmsg(DB) << "\n";
+    }
+    void add_booked_on_column() {
+        vector<string> columns;
+        {
+            Statement<queries::BookingColumns> query(statements);
+            columns = query.bind().all();
+        }
+        if (find(columns.begin(), columns.end(), "booked_on") != columns.end()) return;
+        if (sqlite3_exec(DB, "ALTER TABLE bookings ADD COLUMN booked_on TEXT;", nullptr, nullptr, nullptr) != SQLITE_OK)
+            cerr << "Ошибка обновления таблицы bookings: " << sqlite3_errmsg(DB) << "\n";
+    }
+    void create_change_log() {
+        string sql = "CREATE TABLE IF NOT EXISTS change_log (seq INTEGER PRIMARY KEY AUTOINCREMENT, table_name TEXT NOT NULL, row_id INTEGER);";
+        vector<pair<string, string>> tables = { { "bookings", "booking_id" }, { "rooms", "room_id" }, { "room_types", "type_id" }, { "users", "user_id" } };
+        for (const auto& table : tables) {
+            string insert = "INSERT INTO change_log (table_name, row_id) VALUES ('" + table.first + "', ";
+            sql += "CREATE TRIGGER IF NOT EXISTS log_" + table.first + "_insert AFTER INSERT ON " + table.first + " BEGIN " + insert + "NEW." + table.second + "); END;";
+            sql += "CREATE TRIGGER IF NOT EXISTS log_" + table.first + "_update AFTER UPDATE ON " + table.first + " BEGIN " + insert + "OLD." + table.second + "); "
+                + "INSERT INTO change_log (table_name, row_id) SELECT '" + table.first + "', NEW." + table.second + " WHERE NEW." + table.second + " <> OLD." + table.second + "; END;";
+            sql += "CREATE TRIGGER IF NOT EXISTS log_" + table.first + "_delete AFTER DELETE ON " + table.first + " BEGIN " + insert + "OLD." + table.second + "); END;";
+        }
+
+        char* error = nullptr;
+        if (sqlite3_exec(DB, sql.c_str(), nullptr, nullptr, &error) != SQLITE_OK) {
+            cerr << "Ошибка создания журнала изменений: " << (error ? error : "") << "\n";
+            sqlite3_free(error);
+        }
+        pending_changes.clear();
+        committed_changes.clear();
+    }
+    template <ReservationStatus Status>
+    optional<vector<Reservation>> reservations_by_status(int user_id) {
+        vector<Reservation> reservations;
+        bool ok = false;
+        if (user_id == 12) {
+            Statement<queries::AllReservationsByStatus<Status>> query(statements);
+            reservations = query.bind().all();
+            ok = query.ok();
+        }
+        else {
+            Statement<queries::GuestReservationsByStatus<Status>> query(statements);
+            reservations = query.bind(user_id).all();
+            ok = query.ok();
+        }
+        if (!ok) return nullopt;
+        return reservations;
+    }
+    void publish_changes() {
+        if (!sqlite3_get_autocommit(DB) || committed_changes.empty()) return;
+        ChangeBatch batch;
+        batch.events.swap(committed_changes);
+        for (const auto& event : batch.events)
+            if (event.table == CHANGE_LOG && event.operation == SQLITE_INSERT && event.row_id == logged_seq + 1) logged_seq = event.row_id;
+        if (!change_queue.push(move(batch))) queue_overflow = true;
+    }
+    ChangeBatch read_logged_changes() {
+        ChangeBatch batch;
+        sqlite3_int64 last = get_change_seq();
+        auto first = get_first_change_seq();
+        if (queue_overflow.exchange(false) || logged_seq > last || logged_seq < (first ? first.value() - 1 : last)) {
+            batch.external = true;
+            logged_seq = last;
+            return batch;
+        }
+
+        for (const auto& change : get_changes_since(logged_seq)) {
+            batch.events.push_back({ change.table, SQLITE_UPDATE, change.row_id });
+            batch.events.push_back({ CHANGE_LOG, SQLITE_INSERT, change.seq });
+            logged_seq = change.seq;
+        }
+        return batch;
+    }
 public:
-    Database(const string& path) {
+    Database(const string& path, const StorageProfile& profile = StorageProfile()) : db_path(path), storage(profile) {
         if (sqlite3_open(path.c_str(), &DB) != SQLITE_OK) {
             cerr << "Ошибка открытия базы данных: " << sqlite3_errmsg(DB) << "\n";
             exit(-1);
         }
+        sqlite3_busy_timeout(DB, 5000);
+        sqlite3_exec(DB, "PRAGMA journal_mode=WAL;", nullptr, nullptr, nullptr);
+        if (sqlite3_exec(DB, storage.pragmas().c_str(), nullptr, nullptr, nullptr) != SQLITE_OK)
+            cerr << "Ошибка настройки хранилища: " << sqlite3_errmsg(DB) << "\n";
+        statements.attach(DB);
+        enable_incremental_vacuum();
+        sqlite3_update_hook(DB, on_update, this);
+        sqlite3_commit_hook(DB, on_commit, this);
+        sqlite3_rollback_hook(DB, on_rollback, this);
+        create_change_log();
+        add_booked_on_column();
+        sqlite3_exec(DB, "PRAGMA optimize=0x10002;", nullptr, nullptr, nullptr);
+        data_version = read_data_version();
+        logged_seq = get_change_seq();
+        load_logins();
+        subscribe([this](const ChangeBatch& batch) { on_user_changes(batch); });
+        subscribe([this](const ChangeBatch& batch) { on_search_changes(batch); });
+    }
+    ~Database() {
+        statements.clear();
+        if (DB) {
+            sqlite3_exec(DB, "PRAGMA optimize;", nullptr, nullptr, nullptr);
+            sqlite3_close(DB);
+        }
     }
-    ~Database() { if (DB) sqlite3_close(DB); }
 
-    optional<int> get_user_id(const string& login, const string& password = "", bool check_password = false) {
-        sqlite3_stmt* stmt = nullptr;
-        const char* sql = nullptr;
-        if (check_password) sql = "SELECT user_id FROM users WHERE login = ? AND password = ?;";
-        else sql = "SELECT user_id FROM users WHERE login = ?;";
+    const string& get_path() const { return db_path; }
+    const StorageProfile& get_storage_profile() const { return storage; }
+    StorageStats get_storage_stats() {
+        StorageStats stats{ storage.name, 0, 0, 0, read_auto_vacuum(), 0 };
+        {
+            Statement<queries::FreePages> query(statements);
+            stats.free_pages = query.bind().next().value_or(0);
+        }
+        int highwater = 0;
+        sqlite3_db_status(DB, SQLITE_DBSTATUS_CACHE_HIT, &stats.cache_hits, &highwater, 0);
+        sqlite3_db_status(DB, SQLITE_DBSTATUS_CACHE_MISS, &stats.cache_misses, &highwater, 0);
+        sqlite3_db_status(DB, SQLITE_DBSTATUS_CACHE_USED, &stats.cache_used, &highwater, 0);
+        return stats;
+    }
+    HoldTable& get_holds() { return holds; }
+    SearchCacheStats get_search_stats() const { return searches.get_stats(); }
 
-        optional<int> user_id = nullopt;
+    int subscribe(function<void(const ChangeBatch&)> callback) {
+        subscribers.emplace_back(next_subscriber_id, move(callback));
+        return next_subscriber_id++;
+    }
+    void unsubscribe(int id) {
+        for (auto it = subscribers.begin(); it != subscribers.end(); it++) {
+            if (it->first == id) {
+                subscribers.erase(it);
+                return;
+            }
+        }
+    }
+    void poll_changes() {
+        publish_changes();
+
+        int version = read_data_version();
+        if (version != data_version || queue_overflow) {
+            data_version = version;
+            ChangeBatch batch = read_logged_changes();
+            if ((batch.external || !batch.events.empty()) && !change_queue.push(move(batch))) queue_overflow = true;
+        }
 
-        if (sqlite3_prepare_v2(DB, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-            sqlite3_bind_text(stmt, 1, login.c_str(), -1, SQLITE_TRANSIENT);
-            if (check_password) sqlite3_bind_text(stmt, 2, password.c_str(), -1, SQLITE_TRANSIENT);
-            if (sqlite3_step(stmt) == SQLITE_ROW) user_id = sqlite3_column_int(stmt, 0);
+        while (auto batch = change_queue.pop()) {
+            auto current = subscribers;
+            for (const auto& subscriber : current) subscriber.second(*batch);
         }
-        else cerr << "Ошибка подготовки запроса: " << sqlite3_errmsg(DB) << "\n";
+    }
 
-        if (stmt) sqlite3_finalize(stmt);
-        return user_id;
+    bool is_login_taken(const string& login) {
+        poll_changes();
+        return logins.contains(login);
+    }
+    string generate_login(const string& base) {
+        poll_changes();
+        return logins.generate_free(base);
+    }
+    optional<int> get_user_id(const string& login, const string& password = "", bool check_password = false) {
+        if (check_password) {
+            Statement<queries::UserIdByCredentials> query(statements);
+            return query.bind(login, password).next();
+        }
+        Statement<queries::UserIdByLogin> query(statements);
+        return query.bind(login).next();
     }
     optional<int> create_new_user(const string& login, const string& password, const vector<string>& info) {
         if (sqlite3_exec(DB, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr) != SQLITE_OK) {
@@ -167,29 +1168,19 @@ public:
             return nullopt;
         }
 
-        sqlite3_stmt* stmt = nullptr;
-        const char* sql = "INSERT INTO users (login, password, name, surname, phone, email) VALUES (?, ?, ?, ?, ?, ?);";
-
         bool success = false;
-
-        if (sqlite3_prepare_v2(DB, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-            sqlite3_bind_text(stmt, 1, login.c_str(), -1, SQLITE_TRANSIENT);
-            sqlite3_bind_text(stmt, 2, password.c_str(), -1, SQLITE_TRANSIENT);
-            sqlite3_bind_text(stmt, 3, info[0].c_str(), -1, SQLITE_TRANSIENT);
-            sqlite3_bind_text(stmt, 4, info[1].c_str(), -1, SQLITE_TRANSIENT);
-            sqlite3_bind_text(stmt, 5, info[2].c_str(), -1, SQLITE_TRANSIENT);
-            sqlite3_bind_text(stmt, 6, info[3].c_str(), -1, SQLITE_TRANSIENT);
-
-            if (sqlite3_step(stmt) != SQLITE_DONE) cerr << "Ошибка при выполнении INSERT: " << sqlite3_errmsg(DB) << "\n";
-            else success = true;
+        {
+            Statement<queries::InsertUser> query(statements);
+            if (query.ok()) {
+                if (!query.bind(login, password, info[0], info[1], info[2], info[3]).execute()) cerr << "Ошибка при выполнении INSERT: " << sqlite3_errmsg(DB) << "\n";
+                else success = true;
+            }
         }
-        else cerr << "Ошибка при подготовке запроса: " << sqlite3_errmsg(DB) << "\n";
-
-        if (stmt) sqlite3_finalize(stmt);
 
         if (success) {
-            sqlite3_exec(DB, "COMMIT;", nullptr, nullptr, nullptr);
             int user_id = static_cast<int>(sqlite3_last_insert_rowid(DB));
+            sqlite3_exec(DB, "COMMIT;", nullptr, nullptr, nullptr);
+            poll_changes();
             return user_id;
         }
         else {
@@ -199,290 +1190,999 @@ public:
     }
     void create_reservation(int user_id, int room_id, int guests_num, const string& in, const string& out, const string& status) {
         sqlite3_exec(DB, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
-
-        sqlite3_stmt* stmt;
-        const char* sql = R"( 
-        INSERT INTO bookings (user_id, room_id, guests_num, date_in, date_out, status)
-        VALUES (?, ?, ?, ?, ?, ?);
-    )";
-
-        if (sqlite3_prepare_v2(DB, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-            sqlite3_bind_int(stmt, 1, user_id);
-            sqlite3_bind_int(stmt, 2, room_id);
-            sqlite3_bind_int(stmt, 3, guests_num);
-            sqlite3_bind_text(stmt, 4, in.c_str(), -1, SQLITE_STATIC);
-            sqlite3_bind_text(stmt, 5, out.c_str(), -1, SQLITE_STATIC);
-            sqlite3_bind_text(stmt, 6, status.c_str(), -1, SQLITE_STATIC);
-
-            if (sqlite3_step(stmt) != SQLITE_DONE) {
+        {
+            Statement<queries::InsertBooking> query(statements);
+            if (!query.ok()) sqlite3_exec(DB, "ROLLBACK;", nullptr, nullptr, nullptr);
+            else if (!query.bind(user_id, room_id, guests_num, in, out, status).execute()) {
                 cerr << "Ошибка при выполнении INSERT: " << sqlite3_errmsg(DB) << endl;
                 sqlite3_exec(DB, "ROLLBACK;", nullptr, nullptr, nullptr);
             }
             else {
                 sqlite3_exec(DB, "COMMIT;", nullptr, nullptr, nullptr);
+                handled_bookings.push_back(sqlite3_last_insert_rowid(DB));
+                invalidate_searches(in, out);
                 cout << "Номер забронирован! \n";
             }
+        }
+        poll_changes();
+    }
+    optional <User> get_user_by_id(int id) {
+        Statement<queries::UserById> query(statements);
+        auto user = query.bind(id).next();
+        if (query.ok() && user == nullopt) cerr << "Пользователь с ID '" << id << "' не найден.\n";
+        return user;
+    }
+    vector<Room> new_search(const optional<Filter>& filter) {
+        poll_changes();
+        vector <Room> result;
+        int from = date::to_days(filter->in).value_or(0), to = date::to_days(filter->out).value_or(0);
+
+        const vector<Room>* rooms = searches.find(filter.value());
+        if (!rooms) {
+            Statement<queries::FreeRooms> query(statements);
+            vector<Room> free_rooms = query.bind(filter->in, filter->out, filter->guests).all();
+            if (!query.ok()) return result;
+            rooms = &searches.store(filter.value(), from, to, move(free_rooms));
+        }
 
-            sqlite3_finalize(stmt);
+        for (const auto& room : *rooms) {
+            if (!result.empty() && result.back().get_type() == room.get_type() && result.back().get_capacity() == room.get_capacity()) continue;
+            if (holds.is_held(room.get_id(), from, to)) continue;
+            result.push_back(room);
         }
-        else {
-            cerr << "Ошибка при подготовке запроса: " << sqlite3_errmsg(DB) << endl;
-            sqlite3_exec(DB, "ROLLBACK;", nullptr, nullptr, nullptr);
+        return result;
+    }
+    string get_room_type(int room_id) {
+        Statement<queries::RoomType> query(statements);
+        return query.bind(room_id).next().value_or("");
+    }
+    vector<Room> get_rooms() {
+        Statement<queries::AllRooms> query(statements);
+        return query.bind().all();
+    }
+    vector<Reservation> get_all_reservations() {
+        Statement<queries::AllReservations> query(statements);
+        return query.bind().all();
+    }
+    optional<Reservation> get_reservation_by_id(int id) {
+        Statement<queries::ReservationById> query(statements);
+        return query.bind(id).next();
+    }
+    optional <vector <Reservation>> get_reservations_by_status(ReservationStatus status, int user_id) {
+        switch (status) {
+        case NOT_STARTED: return reservations_by_status<NOT_STARTED>(user_id);
+        case ACTIVE: return reservations_by_status<ACTIVE>(user_id);
+        default: return reservations_by_status<OVER>(user_id);
         }
     }
-    optional <User> get_user_by_id(int id) {
-        sqlite3_stmt* stmt = nullptr;
-        const char* sql = "SELECT login, name, surname, role FROM users WHERE user_id = ?;";
+    vector<Reservation> get_reservations_by_details(const string& search_data) {
+        Statement<queries::ReservationsByDetails> query(statements);
+        return query.bind(search_data, search_data, search_data).all();
+    }
+    void get_payment(int id) {
+        {
+            Statement<queries::ConfirmPayment> query(statements);
+            if (query.ok()) {
+                if (query.bind(id).execute()) {
+                    if (sqlite3_changes(DB) > 0) handled_bookings.push_back(id);
+                    cout << "Оплата подтверждена! \n";
+                }
+                else cerr << "Ошибка при подтверждении оплаты бронирования: " << sqlite3_errmsg(DB) << "\n";
+            }
+        }
+        poll_changes();
+    }
+    void delete_reservation(int id) {
+        auto reservation = get_reservation_by_id(id);
+        {
+            Statement<queries::DeleteBooking> query(statements);
+            if (query.ok()) {
+                if (query.bind(id).execute()) {
+                    if (reservation && sqlite3_changes(DB) > 0) {
+                        handled_bookings.push_back(id);
+                        invalidate_searches(reservation->get_in(), reservation->get_out());
+                    }
+                    cout << "Бронирование удалено из системы!\n";
+                }
+                else cerr << "Ошибка при удалении бронирования: " << sqlite3_errmsg(DB) << "\n";
+            }
+        }
+        poll_changes();
+    }
+    sqlite3_int64 get_change_seq() {
+        Statement<queries::ChangeSeq> query(statements);
+        return query.bind().next().value_or(0);
+    }
+    optional<sqlite3_int64> get_first_change_seq() {
+        Statement<queries::FirstChangeSeq> query(statements);
+        return query.bind().next().value_or(nullopt);
+    }
+    vector<LoggedChange> get_changes_since(sqlite3_int64 seq) {
+        Statement<queries::ChangesSince> query(statements);
+        return query.bind(seq).all();
+    }
+    void prune_change_log(sqlite3_int64 seq) {
+        {
+            Statement<queries::PruneChanges> query(statements);
+            if (query.ok() && !query.bind(seq).execute()) cerr << "Ошибка очистки журнала изменений: " << sqlite3_errmsg(DB) << "\n";
+        }
+        poll_changes();
+    }
+    vector<int> find_booking_ids(const BookingPredicate& predicate) {
+        optional<string> in, out;
+        if (predicate.dates) {
+            in = predicate.dates->in;
+            out = predicate.dates->out;
+        }
+        Statement<queries::BookingIds> query(statements);
+        return query.bind(predicate.user_id, in, out).all();
+    }
+    vector<pair<int, BulkOutcome>> bulk_update(const vector<int>& ids, BulkOperation operation) {
+        return run_bulk([&]() { return ids; }, operation);
+    }
+    vector<pair<int, BulkOutcome>> bulk_update(const BookingPredicate& predicate, BulkOperation operation) {
+        return run_bulk([&]() { return find_booking_ids(predicate); }, operation);
+    }
+};
 
-        optional<User> user = nullopt;
+class MappedFile {
+    HANDLE file = INVALID_HANDLE_VALUE, mapping = nullptr;
+    char* view = nullptr;
+    size_t length = 0;
+public:
+    MappedFile(const string& path) {
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) return;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        if (!mapping) return;
+        view = static_cast<char*>(MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, static_cast<size_t>(size.QuadPart)));
+        if (view) length = static_cast<size_t>(size.QuadPart);
+    }
+    ~MappedFile() {
+        if (view) UnmapViewOfFile(view);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    char* data() const { return view; }
+    size_t size() const { return length; }
+};
 
-        if (sqlite3_prepare_v2(DB, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-            sqlite3_bind_int(stmt, 1, id);
+class AvailabilityIndex {
+    struct Span { size_t room; int from, to; };
+    struct RoomBookings { set<pair<int, int>> by_start; int longest = 0; };
+    struct Option { Room room; int day_in; };
+
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version, room_count, words_per_room, booking_count;
+        int64_t change_seq;
+        uint64_t checksum;
+    };
+    struct SnapshotRoom { int32_t room_id, capacity; double price; char type[64]; };
+    struct SnapshotBooking { int32_t booking_id, room_id, from, to; };
+
+    static constexpr int FIRST_DAY = 11323;
+    static constexpr int DAYS = 36159;
+    static constexpr int WORDS = (DAYS + 63) / 64;
+    static constexpr uint32_t SNAPSHOT_VERSION = 1;
 
-            if (sqlite3_step(stmt) == SQLITE_ROW) {
-                const unsigned char* login_c = sqlite3_column_text(stmt, 0);
-                const unsigned char* name_c = sqlite3_column_text(stmt, 1);
-                const unsigned char* surname_c = sqlite3_column_text(stmt, 2);
-                const unsigned char* role_c = sqlite3_column_text(stmt, 3);
+    Database& db;
+    int subscription = 0;
+    mutex guard;
+    sqlite3_int64 applied_seq = 0;
+    vector<Room> rooms;
+    unordered_map<int, size_t> room_index;
+    unique_ptr<MappedFile> snapshot;
+    vector<uint64_t> owned_calendars;
+    uint64_t* calendars = nullptr;
+    vector<RoomBookings> room_bookings;
+    unordered_map<int, Span> spans;
+
+    uint64_t* calendar(size_t room) { return calendars + room * WORDS; }
+    static uint64_t checksum(const char* data, size_t size) {
+        uint64_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i + 8 <= size; i += 8) {
+            uint64_t word;
+            memcpy(&word, data + i, 8);
+            hash = (hash ^ word) * 1099511628211ULL;
+        }
+        return hash;
+    }
+    static void set_range(uint64_t* bits, int from, int to) {
+        for (int day = max(from, 0); day < min(to, DAYS); day++) bits[day >> 6] |= 1ULL << (day & 63);
+    }
+    static void clear_range(uint64_t* bits, int from, int to) {
+        for (int day = max(from, 0); day < min(to, DAYS); day++) bits[day >> 6] &= ~(1ULL << (day & 63));
+    }
+    static int day_of(const string& str) {
+        auto days = date::to_days(str);
+        return days ? days.value() - FIRST_DAY : -1;
+    }
+    static vector<uint64_t> extract_free(const uint64_t* bits, int from, int length) {
+        vector<uint64_t> result((length + 63) / 64);
+        int words = from >> 6, offset = from & 63;
+        for (int i = 0; i < static_cast<int>(result.size()); i++) {
+            uint64_t low = words + i < WORDS ? bits[words + i] : ~0ULL;
+            uint64_t high = words + i + 1 < WORDS ? bits[words + i + 1] : ~0ULL;
+            result[i] = ~(offset ? (low >> offset) | (high << (64 - offset)) : low);
+        }
+        if (length & 63) result.back() &= (1ULL << (length & 63)) - 1;
+        return result;
+    }
+    static void and_shifted(vector<uint64_t>& bits, int shift) {
+        int words = shift >> 6, offset = shift & 63, size = static_cast<int>(bits.size());
+        for (int i = 0; i < size; i++) {
+            uint64_t low = i + words < size ? bits[i + words] : 0;
+            uint64_t high = i + words + 1 < size ? bits[i + words + 1] : 0;
+            bits[i] &= offset ? (low >> offset) | (high << (64 - offset)) : low;
+        }
+    }
+    void remove_booking(int id) {
+        auto it = spans.find(id);
+        if (it == spans.end()) return;
+        Span span = it->second;
+        spans.erase(it);
+        auto& bookings = room_bookings[span.room];
+        bookings.by_start.erase({ span.from, id });
+
+        clear_range(calendar(span.room), span.from, span.to);
+        auto other = bookings.by_start.lower_bound({ span.from - bookings.longest, INT_MIN });
+        for (; other != bookings.by_start.end() && other->first < span.to; other++) {
+            const Span& kept = spans.find(other->second)->second;
+            set_range(calendar(span.room), max(kept.from, span.from), min(kept.to, span.to));
+        }
+    }
+    void add_span(int id, size_t room, int from, int to) {
+        spans[id] = Span{ room, from, to };
+        room_bookings[room].by_start.emplace_hint(room_bookings[room].by_start.end(), from, id);
+        room_bookings[room].longest = max(room_bookings[room].longest, to - from);
+    }
+    void add_booking(const Reservation& reservation) {
+        auto room = room_index.find(reservation.get_room_id());
+        if (room == room_index.end()) return;
+        int from = day_of(reservation.get_in()), to = day_of(reservation.get_out());
+        add_span(reservation.get_reservation_id(), room->second, from, to);
+        set_range(calendar(room->second), from, to);
+    }
+    void refresh_booking(int id) {
+        auto reservation = db.get_reservation_by_id(id);
+        auto span = spans.find(id);
+        if (reservation && span != spans.end()) {
+            auto room = room_index.find(reservation->get_room_id());
+            if (room != room_index.end() && span->second.room == room->second
+                && span->second.from == day_of(reservation->get_in()) && span->second.to == day_of(reservation->get_out())) return;
+        }
+        remove_booking(id);
+        if (reservation) add_booking(reservation.value());
+    }
+    void reset_rooms(vector<Room> catalog) {
+        rooms = move(catalog);
+        room_index.clear();
+        spans.clear();
+        for (size_t i = 0; i < rooms.size(); i++) room_index[rooms[i].get_id()] = i;
+        room_bookings.assign(rooms.size(), {});
+    }
+    void detach_snapshot() {
+        if (!snapshot) return;
+        owned_calendars.assign(calendars, calendars + rooms.size() * WORDS);
+        calendars = owned_calendars.data();
+        snapshot.reset();
+    }
+    void reload_locked() {
+        applied_seq = db.get_change_seq();
+        reset_rooms(db.get_rooms());
+        snapshot.reset();
+        owned_calendars.assign(rooms.size() * WORDS, 0);
+        calendars = owned_calendars.data();
+        vector<tuple<size_t, int, int, int>> loaded;
+        for (const auto& reservation : db.get_all_reservations()) {
+            auto room = room_index.find(reservation.get_room_id());
+            if (room != room_index.end()) loaded.emplace_back(room->second, day_of(reservation.get_in()), reservation.get_reservation_id(), day_of(reservation.get_out()));
+        }
+        sort(loaded.begin(), loaded.end());
+        for (const auto& [room, from, id, to] : loaded) {
+            add_span(id, room, from, to);
+            set_range(calendar(room), from, to);
+        }
+    }
+    bool load_snapshot(const string& path) {
+        auto file = make_unique<MappedFile>(path);
+        if (file->size() < sizeof(SnapshotHeader)) return false;
+
+        SnapshotHeader header;
+        memcpy(&header, file->data(), sizeof(header));
+        if (memcmp(header.magic, "BKSNAP\0\0", 8) != 0 || header.version != SNAPSHOT_VERSION || header.words_per_room != WORDS) return false;
+
+        size_t rooms_size = static_cast<size_t>(header.room_count) * sizeof(SnapshotRoom), bookings_size = static_cast<size_t>(header.booking_count) * sizeof(SnapshotBooking);
+        size_t expected = sizeof(SnapshotHeader) + rooms_size + bookings_size + static_cast<size_t>(header.room_count) * WORDS * sizeof(uint64_t);
+        if (file->size() != expected || checksum(file->data() + sizeof(header), expected - sizeof(header)) != header.checksum) {
+            cerr << "Снимок доступности повреждён, выполняется полная загрузка. \n";
+            return false;
+        }
 
-                string login_str = login_c ? reinterpret_cast<const char*>(login_c) : "";
-                string name_str = name_c ? reinterpret_cast<const char*>(name_c) : "";
-                string surname_str = surname_c ? reinterpret_cast<const char*>(surname_c) : "";
-                string role_str = role_c ? reinterpret_cast<const char*>(role_c) : "";
+        char* cursor = file->data() + sizeof(header);
+        vector<Room> catalog;
+        for (uint32_t i = 0; i < header.room_count; i++, cursor += sizeof(SnapshotRoom)) {
+            SnapshotRoom record;
+            memcpy(&record, cursor, sizeof(record));
+            record.type[sizeof(record.type) - 1] = '\0';
+            catalog.emplace_back(record.room_id, record.type, record.capacity, record.price);
+        }
+        reset_rooms(move(catalog));
+        for (uint32_t i = 0; i < header.booking_count; i++, cursor += sizeof(SnapshotBooking)) {
+            SnapshotBooking record;
+            memcpy(&record, cursor, sizeof(record));
+            auto room = room_index.find(record.room_id);
+            if (room != room_index.end()) add_span(record.booking_id, room->second, record.from, record.to);
+        }
+
+        calendars = reinterpret_cast<uint64_t*>(cursor);
+        owned_calendars.clear();
+        snapshot = move(file);
+        applied_seq = header.change_seq;
+        return true;
+    }
+    void replay_changes() {
+        sqlite3_int64 last = db.get_change_seq();
+        auto first = db.get_first_change_seq();
+        if (applied_seq > last || applied_seq < (first ? first.value() - 1 : last)) {
+            reload_locked();
+            return;
+        }
 
-                user.emplace(id, login_str, name_str, surname_str, role_str);
+        for (const auto& change : db.get_changes_since(applied_seq)) {
+            if (change.table == ROOMS || change.table == ROOM_TYPES) {
+                reload_locked();
+                return;
             }
-            else cerr << "Пользователь с ID '" << id << "' не найден.\n";
+            if (change.table == BOOKINGS) refresh_booking(static_cast<int>(change.row_id));
+            applied_seq = change.seq;
+        }
+    }
+    void on_changes(const ChangeBatch& batch) {
+        lock_guard<mutex> lock(guard);
+        if (batch.external || batch.touches(ROOMS) || batch.touches(ROOM_TYPES)) {
+            reload_locked();
+            return;
+        }
+        for (const auto& event : batch.events) {
+            if (event.table == BOOKINGS) refresh_booking(static_cast<int>(event.row_id));
+            else if (event.table == CHANGE_LOG && event.operation == SQLITE_INSERT && event.row_id == applied_seq + 1) applied_seq = event.row_id;
         }
-        else cerr << "Ошибка подготовки запроса: " << sqlite3_errmsg(DB) << "\n";
+    }
+public:
+    AvailabilityIndex(Database& database, const string& snapshot_path = "") : db(database) {
+        if (!snapshot_path.empty() && load_snapshot(snapshot_path)) {
+            sqlite3_int64 snapshot_seq = applied_seq;
+            replay_changes();
+            db.prune_change_log(snapshot_seq);
+        }
+        else reload_locked();
+        subscription = db.subscribe([this](const ChangeBatch& batch) { on_changes(batch); });
+    }
+    ~AvailabilityIndex() { db.unsubscribe(subscription); }
+    AvailabilityIndex(const AvailabilityIndex&) = delete;
+    AvailabilityIndex& operator=(const AvailabilityIndex&) = delete;
 
-        if (stmt) sqlite3_finalize(stmt);
-        return user;
+    void reload() {
+        lock_guard<mutex> lock(guard);
+        reload_locked();
     }
-    vector<Room> new_search(const optional<Filter>& filter) {
-        vector <Room> result;
-        sqlite3_stmt* stmt;
-        const char* sql = R"(
-        SELECT r.room_id, rt.name, r.capacity, r.price
-        FROM rooms AS r
-        JOIN room_types AS rt ON r.type_id = rt.type_id
-        WHERE NOT EXISTS (
-            SELECT 1
-            FROM bookings AS b
-            WHERE b.room_id = r.room_id
-                AND b.date_out > ?
-                AND b.date_in < ?
-        )
-        AND r.capacity >= ?
-        GROUP BY r.type_id, r.capacity;)";
+    optional<sqlite3_int64> write_snapshot(const string& path) {
+        vector<char> buffer;
+        sqlite3_int64 change_seq = 0;
+        {
+            lock_guard<mutex> lock(guard);
+            detach_snapshot();
+
+            SnapshotHeader header{};
+            memcpy(header.magic, "BKSNAP\0\0", 8);
+            header.version = SNAPSHOT_VERSION;
+            header.room_count = static_cast<uint32_t>(rooms.size());
+            header.words_per_room = WORDS;
+            header.booking_count = static_cast<uint32_t>(spans.size());
+            header.change_seq = change_seq = applied_seq;
+
+            buffer.resize(sizeof(header) + rooms.size() * sizeof(SnapshotRoom) + spans.size() * sizeof(SnapshotBooking) + rooms.size() * WORDS * sizeof(uint64_t));
+            char* cursor = buffer.data() + sizeof(header);
+            for (const auto& room : rooms) {
+                SnapshotRoom record{};
+                record.room_id = room.get_id();
+                record.capacity = room.get_capacity();
+                record.price = room.get_price();
+                strncpy(record.type, room.get_type().c_str(), sizeof(record.type) - 1);
+                memcpy(cursor, &record, sizeof(record));
+                cursor += sizeof(record);
+            }
+            for (size_t room = 0; room < rooms.size(); room++) {
+                for (const auto& [from, id] : room_bookings[room].by_start) {
+                    SnapshotBooking record{ id, rooms[room].get_id(), from, spans.at(id).to };
+                    memcpy(cursor, &record, sizeof(record));
+                    cursor += sizeof(record);
+                }
+            }
+            memcpy(cursor, calendars, rooms.size() * WORDS * sizeof(uint64_t));
 
-        if (sqlite3_prepare_v2(DB, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-            sqlite3_bind_text(stmt, 1, filter->in.c_str(), -1, SQLITE_TRANSIENT);
-            sqlite3_bind_text(stmt, 2, filter->out.c_str(), -1, SQLITE_TRANSIENT);
-            sqlite3_bind_int(stmt, 3, filter->guests);
+            header.checksum = checksum(buffer.data() + sizeof(header), buffer.size() - sizeof(header));
+            memcpy(buffer.data(), &header, sizeof(header));
+        }
 
-            while (sqlite3_step(stmt) == SQLITE_ROW) {
-                int room_id = sqlite3_column_int(stmt, 0);
-                const unsigned char* room_type = sqlite3_column_text(stmt, 1);
-                int capacity = sqlite3_column_int(stmt, 2);
-                double price = sqlite3_column_double(stmt, 3);
-                int count = sqlite3_column_int(stmt, 4);
+        string temp_path = path + ".tmp";
+        {
+            ofstream file(temp_path, ios::binary | ios::trunc);
+            if (!file.write(buffer.data(), buffer.size())) {
+                cerr << "Ошибка записи снимка доступности! \n";
+                return nullopt;
+            }
+        }
+        error_code error;
+        filesystem::rename(temp_path, path, error);
+        if (error) {
+            cerr << "Ошибка записи снимка доступности: " << error.message() << "\n";
+            return nullopt;
+        }
+        return change_seq;
+    }
+    vector<pair<Room, Filter>> flexible_search(const FlexibleFilter& filter) {
+        db.poll_changes();
+        lock_guard<mutex> lock(guard);
+        vector<Option> options;
+        int from = day_of(filter.from), to = day_of(filter.to), length = to - from;
+        if (from < 0 || to < 0 || filter.nights <= 0 || length < filter.nights) return {};
+
+        map<pair<string, int>, vector<int>> groups;
+        for (size_t room = 0; room < rooms.size(); room++) {
+            if (rooms[room].get_capacity() < filter.guests) continue;
+            groups[{ rooms[room].get_type(), rooms[room].get_capacity() }].push_back(static_cast<int>(room));
+        }
 
-                string str = room_type ? reinterpret_cast<const char*>(room_type) : "";
+        for (const auto& group : groups) {
+            vector<int> chosen(length, -1);
+            for (int room : group.second) {
+                auto feasible = extract_free(calendar(room), from, length);
+                int covered = 1;
+                while (covered * 2 <= filter.nights) {
+                    and_shifted(feasible, covered);
+                    covered *= 2;
+                }
+                if (covered < filter.nights) and_shifted(feasible, filter.nights - covered);
 
-                Room room(room_id, str, capacity, price);
-                result.push_back(room);
+                for (int i = 0; i + filter.nights <= length; i++) {
+                    if (!feasible[i >> 6]) i |= 63;
+                    else if (chosen[i] < 0 && (feasible[i >> 6] >> (i & 63) & 1)
+                        && !db.get_holds().is_held(rooms[room].get_id(), FIRST_DAY + from + i, FIRST_DAY + from + i + filter.nights)) chosen[i] = room;
+                }
             }
+            for (int i = 0; i < length; i++) if (chosen[i] >= 0) options.push_back({ rooms[chosen[i]], from + i });
+        }
+
+        stable_sort(options.begin(), options.end(), [](const Option& a, const Option& b) {
+            if (a.room.get_price() != b.room.get_price()) return a.room.get_price() < b.room.get_price();
+            return a.day_in < b.day_in;
+        });
+
+        vector<pair<Room, Filter>> result;
+        for (const auto& option : options) {
+            string in = date::to_str(date::from_days(FIRST_DAY + option.day_in));
+            string out = date::to_str(date::from_days(FIRST_DAY + option.day_in + filter.nights));
+            result.push_back({ option.room, Filter{ in, out, filter.guests } });
         }
-        if (stmt) sqlite3_finalize(stmt);
         return result;
     }
-    string get_room_type(int room_id) {
-        sqlite3_stmt* stmt;
-        const char* sql = "SELECT rt.name FROM room_types AS rt JOIN rooms AS r ON rt.type_id = r.type_id WHERE room_id = ?;";
-        string type = "";
+};
+
+class SnapshotWriter {
+    AvailabilityIndex& index;
+    string db_path, path;
+    chrono::seconds interval;
+    mutex guard;
+    condition_variable wakeup;
+    bool stopping = false;
+    thread worker;
+
+    void run() {
+        sqlite3* connection = nullptr;
+        bool opened = sqlite3_open(db_path.c_str(), &connection) == SQLITE_OK;
+        if (opened) sqlite3_busy_timeout(connection, 5000);
+        StatementCache statements(opened ? connection : nullptr);
+
+        unique_lock<mutex> lock(guard);
+        while (!wakeup.wait_for(lock, interval, [this] { return stopping; })) {
+            lock.unlock();
+            auto change_seq = index.write_snapshot(path);
+            if (opened && change_seq) {
+                Statement<queries::PruneChanges> query(statements);
+                if (query.ok() && !query.bind(change_seq.value()).execute()) cerr << "Ошибка очистки журнала изменений: " << sqlite3_errmsg(connection) << "\n";
+            }
+            lock.lock();
+        }
+        statements.clear();
+        sqlite3_close(connection);
+    }
+public:
+    SnapshotWriter(const string& database_path, AvailabilityIndex& availability, const string& snapshot_path, chrono::seconds period)
+        : index(availability), db_path(database_path), path(snapshot_path), interval(period), worker(&SnapshotWriter::run, this) {}
+    ~SnapshotWriter() {
+        {
+            lock_guard<mutex> lock(guard);
+            stopping = true;
+        }
+        wakeup.notify_all();
+        worker.join();
+        index.write_snapshot(path);
+    }
+};
+
+class ReportWorker {
+    struct Job {
+        vector<ReportResult> results;
+        int year = 0;
+        atomic<int> completed{ 0 };
+        atomic<bool> cancelled{ false }, failed{ false };
+    };
+
+    string path;
+    mutex guard;
+    condition_variable wakeup;
+    deque<shared_ptr<Job>> tasks;
+    map<int, shared_ptr<Job>> jobs;
+    int next_id = 1;
+    bool stopping = false;
+    vector<thread> workers;
+
+    static int on_progress(void* job) { return static_cast<Job*>(job)->cancelled ? 1 : 0; }
+    static bool run_range(StatementCache& statements, ReportResult& result) {
+        Statement<queries::ReportByStatus> query(statements);
+        result.rows = query.bind(result.range.in, result.range.out).all();
+        return query.ok();
+    }
+    static bool run_year(StatementCache& statements, Job& job) {
+        Statement<queries::ReportByMonth> query(statements);
+        for (const auto& row : query.bind(job.results.front().range.in, job.results.back().range.out).all())
+            job.results[row.month - 1].rows.push_back({ row.status, row.count, row.amount });
+        return query.ok();
+    }
+    int enqueue(const shared_ptr<Job>& job) {
+        lock_guard<mutex> lock(guard);
+        int id = next_id++;
+        jobs[id] = job;
+        tasks.push_back(job);
+        wakeup.notify_one();
+        return id;
+    }
+    void run() {
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+        sqlite3* connection = nullptr;
+        bool opened = sqlite3_open_v2(path.c_str(), &connection, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK;
+        if (opened) sqlite3_busy_timeout(connection, 5000);
+        StatementCache statements(opened ? connection : nullptr);
 
-        if (sqlite3_prepare_v2(DB, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-            sqlite3_bind_int(stmt, 1, room_id);
-            if (sqlite3_step(stmt) == SQLITE_ROW) {
-                const unsigned char* type_c = sqlite3_column_text(stmt, 0);
-                type = type_c ? reinterpret_cast<const char*>(type_c) : "";
+        while (true) {
+            shared_ptr<Job> task;
+            {
+                unique_lock<mutex> lock(guard);
+                wakeup.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (stopping) break;
+                task = move(tasks.front());
+                tasks.pop_front();
             }
+
+            Job& job = *task;
+            sqlite3_progress_handler(connection, 1000, on_progress, &job);
+            if (!opened) job.failed = true;
+            else if (!job.cancelled && !(job.year ? run_year(statements, job) : run_range(statements, job.results.front()))) job.failed = true;
+            job.completed = static_cast<int>(job.results.size());
+            sqlite3_progress_handler(connection, 0, nullptr, nullptr);
         }
-        else cerr << "Ошибка подготовки запроса: " << sqlite3_errmsg(DB) << "\n";
-        if (stmt) sqlite3_finalize(stmt);
-        return type;
+        statements.clear();
+        sqlite3_close(connection);
     }
-    optional <vector <Reservation>> get_reservations_by_status(ReservationStatus status, int user_id) {
-        sqlite3_stmt* stmt = nullptr;
-        vector<Reservation> user_reservations;
-        string sql = R"(
-        SELECT b.booking_id, b.room_id, b.user_id, b.guests_num, b.date_in, b.date_out, r.price * (JULIANDAY(b.date_out) - JULIANDAY(b.date_in)), b.status
-        FROM bookings AS b JOIN rooms AS r ON b.room_id = r.room_id WHERE)";
-        vector<string> conditions;
-
-        if (user_id != 12) conditions.push_back(" b.user_id = ? ");
-
-        if (status == NOT_STARTED) conditions.push_back(" JULIANDAY(b.date_in) > JULIANDAY('NOW') ");
-        else if (status == ACTIVE) conditions.push_back(" JULIANDAY('NOW') BETWEEN JULIANDAY(b.date_in) AND JULIANDAY(b.date_out) ");
-        else conditions.push_back(" JULIANDAY(b.date_out) < JULIANDAY('NOW') ");
+public:
+    ReportWorker(const string& db_path, size_t threads = 2) : path(db_path) {
+        for (size_t i = 0; i < threads; i++) workers.emplace_back(&ReportWorker::run, this);
+    }
+    ~ReportWorker() {
+        {
+            lock_guard<mutex> lock(guard);
+            stopping = true;
+            for (auto& job : jobs) job.second->cancelled = true;
+        }
+        wakeup.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+    ReportWorker(const ReportWorker&) = delete;
+    ReportWorker& operator=(const ReportWorker&) = delete;
 
-        for (int i = 0; i < conditions.size(); i++) {
-            if (i != 0) sql += " AND ";
-            sql += conditions[i];
+    int submit(const Filter& range) {
+        auto job = make_shared<Job>();
+        job->results.push_back({ range, {} });
+        return enqueue(job);
+    }
+    int submit_year(int year) {
+        auto job = make_shared<Job>();
+        job->year = year;
+        for (int month = 1; month <= 12; month++) {
+            Date next = month == 12 ? Date{ 1, 1, year + 1 } : Date{ 1, month + 1, year };
+            job->results.push_back({ Filter{ date::to_str(Date{ 1, month, year }), date::to_str(date::from_days(date::to_days(next) - 1)) }, {} });
         }
-        sql += " ORDER BY date_in ASC;";
+        return enqueue(job);
+    }
+    void cancel(int id) {
+        lock_guard<mutex> lock(guard);
+        auto it = jobs.find(id);
+        if (it != jobs.end()) it->second->cancelled = true;
+    }
+    optional<ReportProgress> progress(int id) {
+        lock_guard<mutex> lock(guard);
+        auto it = jobs.find(id);
+        if (it == jobs.end()) return nullopt;
+
+        const Job& job = *it->second;
+        int completed = job.completed, total = static_cast<int>(job.results.size());
+        ReportState state = REPORT_QUEUED;
+        if (job.cancelled) state = REPORT_CANCELLED;
+        else if (completed == total) state = job.failed ? REPORT_FAILED : REPORT_DONE;
+        else if (completed > 0) state = REPORT_RUNNING;
+        return ReportProgress{ state, completed, total };
+    }
+    vector<int> get_job_ids() {
+        lock_guard<mutex> lock(guard);
+        vector<int> ids;
+        for (const auto& job : jobs) ids.push_back(job.first);
+        return ids;
+    }
+    optional<vector<ReportResult>> collect(int id) {
+        auto state = progress(id);
+        if (state == nullopt || state->completed != state->total) return nullopt;
+
+        lock_guard<mutex> lock(guard);
+        auto job = jobs[id];
+        jobs.erase(id);
+        if (job->cancelled || job->failed) return nullopt;
+        return job->results;
+    }
+};
 
-        if (sqlite3_prepare_v2(DB, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
-            sqlite3_bind_int(stmt, 1, user_id);
+class AsyncDatabase {
+    using Task = function<void(StatementCache&)>;
 
-            while (sqlite3_step(stmt) == SQLITE_ROW) {
-                int booking_id = sqlite3_column_int(stmt, 0);
-                int room_id = sqlite3_column_int(stmt, 1);
-                int guest_id = sqlite3_column_int(stmt, 2);
-                int guests_num = sqlite3_column_int(stmt, 3);
-                const unsigned char* date_in = sqlite3_column_text(stmt, 4);
-                const unsigned char* date_out = sqlite3_column_text(stmt, 5);
-                double price = sqlite3_column_double(stmt, 6);
-                const unsigned char* status = sqlite3_column_text(stmt, 7);
+    string path;
+    LockFreeQueue<Task> tasks{ 1024 };
+    atomic<int> queued{ 0 };
+    mutex guard;
+    condition_variable wakeup;
+    bool stopping = false;
+    vector<thread> workers;
 
-                string in = date_in ? reinterpret_cast<const char*>(date_in) : "";
-                string out = date_out ? reinterpret_cast<const char*>(date_out) : "";
-                string status_str = status ? reinterpret_cast<const char*>(status) : "";
+    void run() {
+        sqlite3* connection = nullptr;
+        bool opened = sqlite3_open_v2(path.c_str(), &connection, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK;
+        if (opened) sqlite3_busy_timeout(connection, 5000);
+        else cerr << "Ошибка открытия базы данных: " << sqlite3_errmsg(connection) << "\n";
+        StatementCache statements(opened ? connection : nullptr);
 
-                Reservation reservation(booking_id, guest_id, room_id, guests_num, in, out, price, status_str);
-                user_reservations.push_back(reservation);
+        while (true) {
+            if (auto task = tasks.pop()) {
+                queued--;
+                (*task)(statements);
+                continue;
             }
+            unique_lock<mutex> lock(guard);
+            wakeup.wait(lock, [this] { return stopping || queued > 0; });
+            if (stopping && queued == 0) break;
         }
-        else {
-            cerr << "Ошибка подготовки запроса: " << sqlite3_errmsg(DB) << "\n";
-            return nullopt;
+        statements.clear();
+        sqlite3_close(connection);
+    }
+public:
+    AsyncDatabase(const string& db_path, size_t threads = 2) : path(db_path) {
+        for (size_t i = 0; i < threads; i++) workers.emplace_back(&AsyncDatabase::run, this);
+    }
+    ~AsyncDatabase() {
+        {
+            lock_guard<mutex> lock(guard);
+            stopping = true;
         }
-        if (stmt) sqlite3_finalize(stmt);
-        return user_reservations;
+        wakeup.notify_all();
+        for (auto& worker : workers) worker.join();
     }
-    vector<Reservation> get_reservations_by_details(const string& search_data) {
-        sqlite3_stmt* stmt = nullptr;
-        vector <Reservation> res_found;
-        const char* sql = R"(
-            SELECT
-	            b.booking_id, b.user_id, b.room_id, b.guests_num, b.date_in, b.date_out,
-	            r.price * (JULIANDAY(b.date_out) - JULIANDAY(b.date_in)), status
-            FROM bookings AS b
-            JOIN users AS u ON b.user_id = u.user_id
-            JOIN rooms AS r ON b.room_id = r.room_id
-            WHERE u.surname = ? OR u.phone = ? OR u.email = ?
-            ORDER BY b.date_in ASC; 
-        )";
-
-        if (sqlite3_prepare_v2(DB, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-            sqlite3_bind_text(stmt, 1, search_data.c_str(), -1, SQLITE_TRANSIENT);
-            sqlite3_bind_text(stmt, 2, search_data.c_str(), -1, SQLITE_TRANSIENT);
-            sqlite3_bind_text(stmt, 3, search_data.c_str(), -1, SQLITE_TRANSIENT);
-
-            while (sqlite3_step(stmt) == SQLITE_ROW) {
-                int booking_id = sqlite3_column_int(stmt, 0);
-                int user_id = sqlite3_column_int(stmt, 1);
-                int room_id = sqlite3_column_int(stmt, 2);
-                int guests_num = sqlite3_column_int(stmt, 3);
-                const unsigned char* c_date_in = sqlite3_column_text(stmt, 4);
-                const unsigned char* c_date_out = sqlite3_column_text(stmt, 5);
-                double full_price = sqlite3_column_double(stmt, 6);
-                const unsigned char* c_status = sqlite3_column_text(stmt, 7);
-
-                string date_in = c_date_in ? reinterpret_cast<const char*>(c_date_in) : "";
-                string date_out = c_date_out ? reinterpret_cast<const char*>(c_date_out) : "";
-                string status = c_status ? reinterpret_cast<const char*>(c_status) : "";
-
-                Reservation reservation(booking_id, user_id, room_id, guests_num, date_in, date_out, full_price, status);
-
-                res_found.push_back(reservation);
+    AsyncDatabase(const AsyncDatabase&) = delete;
+    AsyncDatabase& operator=(const AsyncDatabase&) = delete;
+
+    template <typename Work>
+    future<invoke_result_t<Work, StatementCache&>> submit(Work work) {
+        using Result = invoke_result_t<Work, StatementCache&>;
+        auto done = make_shared<promise<Result>>();
+        auto result = done->get_future();
+        Task task = [done, work](StatementCache& statements) {
+            try {
+                if constexpr (is_void_v<Result>) {
+                    work(statements);
+                    done->set_value();
+                }
+                else done->set_value(work(statements));
             }
+            catch (...) {
+                done->set_exception(current_exception());
+            }
+        };
+        while (!tasks.push(task)) this_thread::yield();
+        queued++;
+        {
+            lock_guard<mutex> lock(guard);
         }
-        if (stmt) sqlite3_finalize(stmt);
-        return res_found;
+        wakeup.notify_one();
+        return result;
+    }
+    template <typename Q, typename... Args>
+    auto fetch_one(Args... args) {
+        return submit([args...](StatementCache& statements) {
+            Statement<Q> query(statements);
+            return query.bind(args...).next();
+        });
+    }
+    template <typename Q, typename... Args>
+    auto fetch_all(Args... args) {
+        return submit([args...](StatementCache& statements) {
+            Statement<Q> query(statements);
+            return query.bind(args...).all();
+        });
     }
-    void get_payment(int id) {
-        sqlite3_stmt* stmt = nullptr;
-        const char* sql = "UPDATE bookings SET status = 'paid' WHERE booking_id = ?;";
 
-        if (sqlite3_prepare_v2(DB, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-            sqlite3_bind_int(stmt, 1, id);
+    future<optional<User>> get_user_by_id(int id) { return fetch_one<queries::UserById>(id); }
+    future<string> get_room_type(int room_id) {
+        return submit([room_id](StatementCache& statements) {
+            Statement<queries::RoomType> query(statements);
+            return query.bind(room_id).next().value_or("");
+        });
+    }
+    future<optional<Reservation>> get_reservation_by_id(int id) { return fetch_one<queries::ReservationById>(id); }
+    future<vector<Reservation>> get_reservations_by_details(const string& search_data) {
+        return fetch_all<queries::ReservationsByDetails>(search_data, search_data, search_data);
+    }
+};
 
-            if (sqlite3_step(stmt) == SQLITE_DONE) cout << "Оплата подтверждена! \n";
-            else cerr << "Ошибка при подтверждении оплаты бронирования: " << sqlite3_errmsg(DB) << "\n";
+namespace analytics {
+    constexpr int LEAD_TIME_LIMITS[] = { 0, 7, 30, 90, INT_MAX };
+    constexpr int LENGTH_OF_STAY_LIMITS[] = { 1, 2, 3, 7, 14, INT_MAX };
+    const char* LEAD_TIME_LABELS[] = { "0", "1-7", "8-30", "31-90", "91+" };
+    const char* LENGTH_OF_STAY_LABELS[] = { "1", "2", "3", "4-7", "8-14", "15+" };
+    const char* WEEKDAYS[] = { "Пн", "Вт", "Ср", "Чт", "Пт", "Сб", "Вс" };
+
+    int weekday(int days) { return (days % 7 + 10) % 7; }
+    template <size_t N>
+    int bucket(int value, const int (&limits)[N]) {
+        int index = 0;
+        for (size_t i = 0; i + 1 < N; i++) index += value > limits[i];
+        return index;
+    }
+    void add(RevenueCell& total, const RevenueCell& cell) {
+        total.available += cell.available;
+        total.sold += cell.sold;
+        total.guest_nights += cell.guest_nights;
+        total.revenue += cell.revenue;
+    }
+    double occupancy(const RevenueCell& cell) { return cell.available ? 100.0 * cell.sold / cell.available : 0.0; }
+    double adr(const RevenueCell& cell) { return cell.sold ? cell.revenue / cell.sold : 0.0; }
+    double revpar(const RevenueCell& cell) { return cell.available ? cell.revenue / cell.available : 0.0; }
+    RevenueCell by_type(const AnalyticsReport& report, size_t type) {
+        RevenueCell total{};
+        for (const auto& cell : report.cells[type]) add(total, cell);
+        return total;
+    }
+    RevenueCell by_weekday(const AnalyticsReport& report, int day) {
+        RevenueCell total{};
+        for (const auto& row : report.cells) add(total, row[day]);
+        return total;
+    }
+    void write_csv(const AnalyticsReport& report, ostream& out) {
+        out << "section,room_type,weekday,available,sold,guest_nights,revenue,occupancy,adr,revpar\n" << fixed << setprecision(2);
+        for (size_t type = 0; type < report.types.size(); type++) {
+            for (int day = 0; day < 7; day++) {
+                const RevenueCell& cell = report.cells[type][day];
+                out << "revenue," << report.types[type] << "," << day + 1 << "," << cell.available << "," << cell.sold << "," << cell.guest_nights << ","
+                    << cell.revenue << "," << occupancy(cell) << "," << adr(cell) << "," << revpar(cell) << "\n";
+            }
         }
-        else cerr << "Ошибка подготовки запроса: " << sqlite3_errmsg(DB) << "\n";
-
-        if (stmt) sqlite3_finalize(stmt);
+        out << "section,bucket,count\n";
+        for (size_t i = 0; i < report.lead_time.size(); i++) out << "lead_time," << LEAD_TIME_LABELS[i] << "," << report.lead_time[i] << "\n";
+        for (size_t i = 0; i < report.length_of_stay.size(); i++) out << "length_of_stay," << LENGTH_OF_STAY_LABELS[i] << "," << report.length_of_stay[i] << "\n";
     }
-    void delete_reservation(int id) {
-        sqlite3_stmt* stmt = nullptr;
-        const char* sql = "DELETE FROM bookings WHERE booking_id = ?;";
+}
 
-        if (sqlite3_prepare_v2(DB, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-            sqlite3_bind_int(stmt, 1, id);
+class BookingAnalytics {
+    static constexpr size_t BLOCK = 1024;
+    static constexpr int UNKNOWN_DAY = INT_MIN;
+
+    string path;
+    vector<int> type_index, day_in, day_out, guests, booked_on;
+    vector<double> price;
+    vector<uint8_t> paid;
+    vector<string> type_names;
+    vector<int> type_rooms;
+
+    struct Partial {
+        vector<array<RevenueCell, 7>> cells;
+        array<long long, 5> lead_time{};
+        array<long long, 6> length_of_stay{};
+    };
+
+    void run_range(const AnalyticsFilter& filter, size_t begin, size_t end, Partial& partial) const {
+        partial.cells.assign(type_names.size(), {});
+        int nights[BLOCK], arrived[BLOCK];
+
+        for (size_t block = begin; block < end; block += BLOCK) {
+            size_t count = min(BLOCK, end - block);
+            const int* in = day_in.data() + block;
+            const int* out = day_out.data() + block;
+            const uint8_t* is_paid = paid.data() + block;
+            int include_unpaid = !filter.paid_only;
+
+            for (size_t i = 0; i < count; i++) {
+                int selected = is_paid[i] | include_unpaid;
+                int overlap = min(out[i], filter.to) - max(in[i], filter.from);
+                nights[i] = overlap > 0 ? overlap * selected : 0;
+                arrived[i] = (in[i] >= filter.from) & (in[i] < filter.to) & selected;
+            }
 
-            if (sqlite3_step(stmt) == SQLITE_DONE) cout << "Бронирование удалено из системы!\n";
-            else cerr << "Ошибка при удалении бронирования: " << sqlite3_errmsg(DB) << "\n";
+            for (size_t i = 0; i < count; i++) {
+                size_t row = block + i;
+                if (nights[i]) {
+                    auto& cells = partial.cells[type_index[row]];
+                    int first = analytics::weekday(max(in[i], filter.from)), full_weeks = nights[i] / 7, rest = nights[i] % 7;
+                    for (int day = 0; day < 7; day++) {
+                        int sold = full_weeks + ((day - first + 7) % 7 < rest);
+                        cells[day].sold += sold;
+                        cells[day].guest_nights += static_cast<long long>(sold) * guests[row];
+                        cells[day].revenue += sold * price[row];
+                    }
+                }
+                if (arrived[i]) {
+                    partial.length_of_stay[analytics::bucket(out[i] - in[i], analytics::LENGTH_OF_STAY_LIMITS)]++;
+                    if (booked_on[row] != UNKNOWN_DAY) partial.lead_time[analytics::bucket(in[i] - booked_on[row], analytics::LEAD_TIME_LIMITS)]++;
+                }
+            }
         }
-        else cerr << "Ошибка подготовки запроса: " << sqlite3_errmsg(DB) << "\n";
-
-        if (stmt) sqlite3_finalize(stmt);
     }
-    void get_report_by_dates(const optional<Filter>& filter) {
-        Ui::separator();
-        sqlite3_stmt* stmt = nullptr;
-        cout << "Отчёт: " << filter->in << " - " << filter->out << "\n";
-        const char* sql = R"(
-        SELECT 
-	        COUNT(b.booking_id),
-	        SUM(r.price) * (JULIANDAY(b.date_out) - JULIANDAY(b.date_in)),
-            b.status
-        FROM
-	        bookings AS b
-        JOIN rooms AS r ON b.room_id = r.room_id
-        WHERE b.date_in >= ? AND b.date_out <= ?
-        GROUP BY b.status;)";
+public:
+    explicit BookingAnalytics(const string& db_path) : path(db_path) {}
 
-        if (sqlite3_prepare_v2(DB, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-            sqlite3_bind_text(stmt, 1, filter->in.c_str(), -1, SQLITE_TRANSIENT);
-            sqlite3_bind_text(stmt, 2, filter->out.c_str(), -1, SQLITE_TRANSIENT);
+    bool load() {
+        sqlite3* connection = nullptr;
+        if (sqlite3_open_v2(path.c_str(), &connection, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+            sqlite3_close(connection);
+            return false;
+        }
+        sqlite3_busy_timeout(connection, 5000);
+        StatementCache statements(connection);
+        bool loaded = false;
+        {
+            Statement<queries::RoomInventoryByType> inventory(statements);
+            vector<RoomInventory> types = inventory.bind().all();
+            Statement<queries::AnalyticsBookings> bookings(statements);
+            vector<AnalyticsRow> rows = bookings.bind().all();
+
+            if (inventory.ok() && bookings.ok()) {
+                unordered_map<int, int> dense;
+                type_names.clear();
+                type_rooms.clear();
+                for (const auto& type : types) {
+                    dense[type.type_id] = static_cast<int>(type_names.size());
+                    type_names.push_back(type.name);
+                    type_rooms.push_back(type.rooms);
+                }
 
-            bool found = false;
+                for (auto column : { &type_index, &day_in, &day_out, &guests, &booked_on }) {
+                    column->clear();
+                    column->reserve(rows.size());
+                }
+                price.clear();
+                paid.clear();
+                for (const auto& row : rows) {
+                    auto type = dense.find(row.type_id);
+                    auto in = date::to_days(row.in), out = date::to_days(row.out);
+                    if (type == dense.end() || !in || !out) continue;
+                    type_index.push_back(type->second);
+                    day_in.push_back(in.value());
+                    day_out.push_back(out.value());
+                    guests.push_back(row.guests);
+                    booked_on.push_back(row.booked_on ? date::to_days(row.booked_on.value()).value_or(UNKNOWN_DAY) : UNKNOWN_DAY);
+                    price.push_back(row.price);
+                    paid.push_back(row.status == "paid");
+                }
+                loaded = true;
+            }
+        }
+        statements.clear();
+        sqlite3_close(connection);
+        return loaded;
+    }
+    size_t size() const { return day_in.size(); }
+    AnalyticsReport analyze(const AnalyticsFilter& filter, size_t threads = thread::hardware_concurrency()) const {
+        AnalyticsReport report{ filter, type_names, vector<array<RevenueCell, 7>>(type_names.size()), {}, {} };
+
+        size_t chunks = max<size_t>(1, min(threads, (size() + BLOCK - 1) / BLOCK));
+        vector<Partial> partials(chunks);
+        vector<thread> workers;
+        size_t chunk = (size() + chunks - 1) / chunks;
+        for (size_t i = 1; i < chunks; i++)
+            workers.emplace_back(&BookingAnalytics::run_range, this, cref(filter), i * chunk, min(size(), (i + 1) * chunk), ref(partials[i]));
+        run_range(filter, 0, min(size(), chunk), partials[0]);
+        for (auto& worker : workers) worker.join();
+
+        for (const auto& partial : partials) {
+            for (size_t type = 0; type < type_names.size(); type++)
+                for (int day = 0; day < 7; day++) analytics::add(report.cells[type][day], partial.cells[type][day]);
+            for (size_t i = 0; i < report.lead_time.size(); i++) report.lead_time[i] += partial.lead_time[i];
+            for (size_t i = 0; i < report.length_of_stay.size(); i++) report.length_of_stay[i] += partial.length_of_stay[i];
+        }
 
-            while (sqlite3_step(stmt) == SQLITE_ROW) {
-                found = true;
-                int count = sqlite3_column_int(stmt, 0);
-                double amount = sqlite3_column_double(stmt, 1);
-                const unsigned char* status_c = sqlite3_column_text(stmt, 2);
-                string status = status_c ? reinterpret_cast<const char*>(status_c) : "";
+        for (int day = filter.from; day < filter.to; day++)
+            for (size_t type = 0; type < type_names.size(); type++) report.cells[type][analytics::weekday(day)].available += type_rooms[type];
+        return report;
+    }
+};
 
-                cout << fixed << setprecision(2) << "Статус: " << status << " | Всего бронирований: " << count << " | Сумма: " << amount << " руб. \n";
+class StorageMaintenance {
+    string path;
+    StorageProfile profile;
+    mutex guard;
+    condition_variable wakeup;
+    bool stopping = false;
+    thread worker;
+
+    void run() {
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+        sqlite3* connection = nullptr;
+        if (sqlite3_open(path.c_str(), &connection) != SQLITE_OK) {
+            sqlite3_close(connection);
+            return;
+        }
+        sqlite3_busy_timeout(connection, 5000);
+        string sql = "PRAGMA optimize=0x10002; PRAGMA incremental_vacuum(" + to_string(profile.vacuum_pages) + ");";
+
+        unique_lock<mutex> lock(guard);
+        while (!wakeup.wait_for(lock, chrono::minutes(profile.maintenance_minutes), [this] { return stopping; })) {
+            lock.unlock();
+            char* error = nullptr;
+            if (sqlite3_exec(connection, sql.c_str(), nullptr, nullptr, &error) != SQLITE_OK) {
+                cerr << "Ошибка обслуживания базы данных: " << (error ? error : "") << "\n";
+                sqlite3_free(error);
             }
-            if (!found) cout << "Нет данных за указанный период.\n";
-
+            lock.lock();
+        }
+        sqlite3_close(connection);
+    }
+public:
+    StorageMaintenance(const string& db_path, const StorageProfile& storage_profile) : path(db_path), profile(storage_profile) {
+        if (profile.maintenance_minutes > 0) worker = thread(&StorageMaintenance::run, this);
+    }
+    ~StorageMaintenance() {
+        {
+            lock_guard<mutex> lock(guard);
+            stopping = true;
         }
-        else cerr << "Ошибка подготовки запроса: " << sqlite3_errmsg(DB) << "\n";
-        if (stmt) sqlite3_finalize(stmt);
+        wakeup.notify_all();
+        if (worker.joinable()) worker.join();
     }
 };
 
 class Validator {
-    static bool check_integer(const string& str) {
-        static const regex int_regex(R"(^\d+$)");
-        return regex_match(str, int_regex);
-    }
 public:
     static int get_valid_choice(int min_value, int max_value) {
         while (true) {
             string choice;
             cin >> choice;
-            if (!check_integer(choice)) {
+            auto parsed = parse::integer(choice);
+            if (!parsed) {
                 cout << "Ошибка ввода! Пожалуйста, введите число. \n";
                 continue;
             }
-            int num = stoi(choice);
+            int num = parsed.value;
             if (num < min_value || num > max_value) {
                 cout << "Ошибка ввода! Число должно быть от " << min_value << " до " << max_value << ".\n";
                 continue;
@@ -490,6 +2190,39 @@ public:
             return num;
         }
     }
+    static vector<int> get_valid_choices(int min_value, int max_value) {
+        while (true) {
+            string input;
+            cin >> input;
+            vector<int> choices;
+            bool valid = true;
+
+            size_t start = 0;
+            while (valid && start <= input.size()) {
+                size_t end = input.find(',', start);
+                if (end == string::npos) end = input.size();
+                string_view part = string_view(input).substr(start, end - start);
+                size_t dash = part.find('-');
+                auto first = parse::integer(part.substr(0, dash)), last = dash == string_view::npos ? first : parse::integer(part.substr(dash + 1));
+
+                if (!first || !last) valid = false;
+                else {
+                    int from = first.value, to = last.value;
+                    if (from > to || from < min_value || to > max_value) valid = false;
+                    else for (int num = from; num <= to; num++) choices.push_back(num);
+                }
+                start = end + 1;
+            }
+
+            if (!valid) {
+                cout << "Ошибка ввода! Введите номера от " << min_value << " до " << max_value << " через запятую или диапазоном (например: 1,3,5-7).\n";
+                continue;
+            }
+            sort(choices.begin(), choices.end());
+            choices.erase(unique(choices.begin(), choices.end()), choices.end());
+            return choices;
+        }
+    }
     static bool is_passwords_matches(const string& password) {
         string password_confirmation;
         cout << "Подтвердите пароль: ";
@@ -499,9 +2232,9 @@ public:
 };
 
 class UserHelper {
-    static bool is_name_correct(const string& input) { return regex_match(input, regex("\\D+")); }
-    static bool is_phone_correct(const string& input) { return regex_match(input, regex("\\+?[0-9]+")); }
-    static bool is_email_correct(const string& input) { return regex_match(input, regex("\\w+[@]\\w+[.]\\w+")); }
+    static bool is_name_correct(const string& input) { return parse::name(input) == PARSE_OK; }
+    static bool is_phone_correct(const string& input) { return parse::phone(input) == PARSE_OK; }
+    static bool is_email_correct(const string& input) { return parse::email(input) == PARSE_OK; }
     static string get_correct_input(char mode) {
         while (true) {
             string input;
@@ -580,7 +2313,7 @@ public:
                 return 0;
             }
 
-            if (db.get_user_id(login) != nullopt) {
+            if (db.is_login_taken(login)) {
                 cout << "Логин занят!\n";
                 continue;
             }
@@ -611,7 +2344,9 @@ public:
 
 class BookingSystem {
 protected:
+    static constexpr chrono::seconds HOLD_TTL = chrono::minutes(10);
     Database& db;
+    AvailabilityIndex& availability;
     optional <User> user;
     optional <Filter> build_filter() {
         Date date_in = date::get_date(), date_out = date::get_date(1);
@@ -650,6 +2385,52 @@ protected:
             }
         }
     }
+    optional <FlexibleFilter> build_flexible_filter() {
+        Date date_from = date::get_date(1), date_to = date::get_date(8);
+        int nights = 1, guests = 2;
+
+        while (true) {
+            Ui::separator();
+            cout << "Период: " << date::to_str(date_from) << " - " << date::to_str(date_to) << " | Ночей: " << nights << " | Гостей: " << guests
+                << "\n1. Начало периода \n2. Конец периода \n3. Количество ночей \n4. Гости \n5. Поиск \n0. Вернуться в меню \n";
+
+            int choice = Validator::get_valid_choice(0, 5);
+
+            switch (choice) {
+            case 0: return nullopt;
+            case 1: {
+                Date temp_from = date::input_date();
+                if (date::to_time_t(temp_from) <= date::to_time_t(date::get_date())) {
+                    cerr << "Начало периода должно быть позже сегодняшнего дня! \n";
+                    break;
+                }
+                if (date::to_time_t(temp_from) >= date::to_time_t(date_to)) date_to = date::get_date(nights, date::to_time_t(temp_from));
+                date_from = temp_from;
+                break;
+            }
+            case 2: {
+                Date temp_to = date::input_date();
+                if (date::to_time_t(temp_to) <= date::to_time_t(date_from)) cerr << "Конец периода должен быть позже начала! \n";
+                else date_to = temp_to;
+                break;
+            }
+            case 3: {
+                Ui::separator();
+                cout << "Введите количество ночей: ";
+                int temp_nights = Validator::get_valid_choice(1, 90);
+                if (temp_nights > date::days_between_dates(date_from, date_to)) cerr << "Период короче указанного количества ночей! \n";
+                else nights = temp_nights;
+                break;
+            }
+            case 4: {
+                int temp_guests = UserHelper::input_guests();
+                if (temp_guests > 0) guests = temp_guests;
+                break;
+            }
+            case 5: return FlexibleFilter{ date::to_str(date_from), date::to_str(date_to), nights, guests };
+            }
+        }
+    }
     int room_choice(const vector<Room>& rooms_found) {
         while (true) {
             Ui::separator();
@@ -690,6 +2471,46 @@ protected:
         case 2: return "not paid";
         }
     }
+    bool confirm_reservation(const Room& room, const optional<Filter>& filter, const optional<User>& user) {
+        auto hold = db.get_holds().acquire(room.get_id(), date::to_days(filter->in).value(), date::to_days(filter->out).value(), HOLD_TTL);
+        if (hold == nullopt) {
+            cout << "Номер уже удерживается другим бронированием, выберите другой вариант! \n";
+            return false;
+        }
+
+        bool confirmed = complete_reservation(room, filter, user, hold.value());
+        db.get_holds().release(hold.value());
+        return confirmed;
+    }
+    bool complete_reservation(const Room& room, const optional<Filter>& filter, const optional<User>& user, int hold) {
+        int days = date::days_between_dates(date::parse_date(filter->in).value(), date::parse_date(filter->out).value());
+        double full_price = room.get_price() * days;
+
+        if (!is_reservation_details(days, full_price, room, filter)) return false;
+
+        auto payment_type = choose_payment_method(full_price);
+        if (payment_type == nullopt) return false;
+
+        vector<string> user_info;
+        if (user == nullopt) user_info = UserHelper::input_user_information();
+
+        if (!db.get_holds().is_active(hold)) {
+            cout << "Время удержания номера истекло, пожалуйста, повторите поиск! \n";
+            return false;
+        }
+
+        int user_id = 0;
+        if (user != nullopt) user_id = user->get_id();
+        else {
+            string new_login = db.generate_login(user_info[2]), new_password = user_info[2];
+            auto new_user_id = db.create_new_user(new_login, new_password, user_info);
+            if (new_user_id == nullopt) return false;
+            user_id = new_user_id.value();
+        }
+
+        db.create_reservation(user_id, room.get_id(), filter->guests, filter->in, filter->out, payment_type.value());
+        return true;
+    }
     void reservation_process(const optional<User>& user) {
         while (true) {
             auto filter = build_filter();
@@ -705,29 +2526,36 @@ protected:
             while (true) {
                 int room_num = room_choice(available_rooms);
                 if (room_num == 0) break;
+                if (confirm_reservation(available_rooms[room_num - 1], filter, user)) return;
+            }
+        }
+    }
+    int flexible_choice(const vector<pair<Room, Filter>>& options) {
+        Ui::separator();
+        cout << "Пожалуйста, выберите вариант (0 - назад): \n";
+        for (int i = 0; i < options.size(); i++) {
+            const Room& room = options[i].first;
+            int days = date::days_between_dates(date::parse_date(options[i].second.in).value(), date::parse_date(options[i].second.out).value());
+            cout << i + 1 << ". " << room.get_type() << " | Вместимость: " << room.get_capacity() << " чел. | Даты: " << options[i].second.in
+                << " - " << options[i].second.out << " | Итого: " << room.get_price() * days << " руб. \n";
+        }
+        return Validator::get_valid_choice(0, options.size());
+    }
+    void flexible_reservation_process(const optional<User>& user) {
+        while (true) {
+            auto filter = build_flexible_filter();
+            if (filter == nullopt) return;
 
-                int days = date::days_between_dates(date::parse_date(filter->in).value(), date::parse_date(filter->out).value());
-                double full_price = available_rooms[room_num - 1].get_price() * days;
-
-                if (!is_reservation_details(days, full_price, available_rooms[room_num - 1], filter)) continue;
-
-                auto payment_type = choose_payment_method(full_price);
-                if (payment_type == nullopt) continue;
-
-                int user_id = 0;
-                if (user != nullopt) user_id = user->get_id();
-                else {
-                    vector<string> user_info = UserHelper::input_user_information();
-                    string new_login = user_info[2], new_password = user_info[2];
-                    while (true) {
-                        if (db.get_user_id(new_login) == nullopt) break;
-                        new_login += to_string(new_login.size());
-                    }
-                    user_id = db.create_new_user(new_login, new_password, user_info).value();
-                }
+            auto options = availability.flexible_search(filter.value());
+            if (options.empty()) {
+                cout << "Нет доступных номеров по заданным параметрам! \n";
+                continue;
+            }
 
-                db.create_reservation(user_id, available_rooms[room_num - 1].get_id(), filter->guests, filter->in, filter->out, payment_type.value());
-                return;
+            while (true) {
+                int option_num = flexible_choice(options);
+                if (option_num == 0) break;
+                if (confirm_reservation(options[option_num - 1].first, options[option_num - 1].second, user)) return;
             }
         }
     }
@@ -766,8 +2594,8 @@ private:
     void guest_process() {
         while (true) {
             Ui::welcome(user->get_name(), user->get_surname());
-            cout << "1. Новое бронирование \n2. Мои бронирования \n0. Выйти из профиля \n";
-            int choice = Validator::get_valid_choice(0, 2);
+            cout << "1. Новое бронирование \n2. Мои бронирования \n3. Гибкий поиск по датам \n0. Выйти из профиля \n";
+            int choice = Validator::get_valid_choice(0, 3);
 
             switch (choice) {
             case 0: return;
@@ -777,24 +2605,43 @@ private:
             case 2:
                 reservations();
                 break;
+            case 3:
+                flexible_reservation_process(user);
+                break;
             }
         }
     }
 public:
-    BookingSystem(Database& database, User _user) : db(database) {
+    BookingSystem(Database& database, AvailabilityIndex& index, User _user) : db(database), availability(index) {
         user = _user;
     }
     virtual void start() { guest_process(); }
 };
 
 class AdminSystem : public BookingSystem {
+    ReportWorker reports{ db.get_path() };
+    AsyncDatabase async_db{ db.get_path() };
+    BookingAnalytics analytics{ db.get_path() };
+    vector<pair<optional<User>, string>> fetch_details(const vector<Reservation>& reservations_list) {
+        vector<future<optional<User>>> guests;
+        vector<future<string>> types;
+        for (const auto& res : reservations_list) {
+            guests.push_back(async_db.get_user_by_id(res.get_guest_id()));
+            types.push_back(async_db.get_room_type(res.get_room_id()));
+        }
+
+        vector<pair<optional<User>, string>> details;
+        for (size_t i = 0; i < reservations_list.size(); i++) details.push_back({ guests[i].get(), types[i].get() });
+        return details;
+    }
     void print_bookings(const optional<vector<Reservation>>& reservations_list) {
         Ui::separator();
+        auto details = fetch_details(reservations_list.value_or(vector<Reservation>()));
         int count = 0, n = 1;
-        for (int i = 0; i < reservations_list->size(); i++, n++, count++) {
+        for (int i = 0; i < details.size(); i++, n++, count++) {
             const Reservation& res = (*reservations_list)[i];
-            auto guest = db.get_user_by_id(res.get_guest_id());
-            cout << n << "." << "" "Категория номера: " << db.get_room_type(res.get_room_id()) << "\n"
+            const auto& guest = details[i].first;
+            cout << n << "." << "" "Категория номера: " << details[i].second << "\n"
                 << "Имя: " << guest->get_name() << " " << guest->get_surname() << "\n"
                 << "Гости: " << res.get_guests_num() << " | Номер комнаты: " << res.get_room_id() << " | Даты: " << res.get_in() << " - " << res.get_out() << "\n"
                 << "Стоимость: " << res.get_total_price() << " | Статус: " << res.get_reservation_status() << "\n\n";
@@ -802,41 +2649,56 @@ class AdminSystem : public BookingSystem {
 
         if (count == 0) cout << "Бронирования не найдены! \n";
     }
-    int find_reservation_id(const vector<Reservation>& r_found) {
-        while (true) {
-            Ui::separator();
-            int counter = 1;
-            for (int i = 0; i < r_found.size(); i++, counter++) {
-                const auto& res = r_found[i];
-                optional<User> user = db.get_user_by_id(res.get_guest_id());
-
-                cout << counter << ". " << "" "Категория номера: " << db.get_room_type(res.get_room_id()) << "\n"
-                    << "Имя: " << user->get_name() << " " << user->get_surname() << "\n"
-                    << "Гости: " << res.get_guests_num() << " | Номер комнаты: " << res.get_room_id() << " | Даты: " << res.get_in() << " - " << res.get_out() << "\n"
-                    << "Стоимость: " << res.get_total_price() << " | Статус: " << res.get_reservation_status() << "\n\n";
-            }
+    vector<int> find_reservation_ids(const vector<Reservation>& r_found) {
+        Ui::separator();
+        auto details = fetch_details(r_found);
+        int counter = 1;
+        for (int i = 0; i < r_found.size(); i++, counter++) {
+            const auto& res = r_found[i];
+            const auto& user = details[i].first;
+
+            cout << counter << ". " << "" "Категория номера: " << details[i].second << "\n"
+                << "Имя: " << user->get_name() << " " << user->get_surname() << "\n"
+                << "Гости: " << res.get_guests_num() << " | Номер комнаты: " << res.get_room_id() << " | Даты: " << res.get_in() << " - " << res.get_out() << "\n"
+                << "Стоимость: " << res.get_total_price() << " | Статус: " << res.get_reservation_status() << "\n\n";
+        }
 
-            cout << "Выберите бронирование (0 — назад): ";
-            int choice = Validator::get_valid_choice(0, r_found.size());
-            if (choice == 0) return 0;
+        cout << "Выберите бронирования, например 1 или 1,3,5-7 (0 — назад): ";
+        vector<int> choices = Validator::get_valid_choices(0, r_found.size());
+        if (find(choices.begin(), choices.end(), 0) != choices.end()) return {};
 
-            return r_found[choice - 1].get_reservation_id();
+        vector<int> ids;
+        for (int choice : choices) ids.push_back(r_found[choice - 1].get_reservation_id());
+        return ids;
+    }
+    void print_bulk_outcomes(const vector<pair<int, BulkOutcome>>& outcomes) {
+        Ui::separator();
+        int done = 0;
+        for (const auto& outcome : outcomes) {
+            cout << "Бронирование #" << outcome.first << ": ";
+            if (outcome.second == BULK_DONE) {
+                cout << "выполнено \n";
+                done++;
+            }
+            else if (outcome.second == BULK_NOT_FOUND) cout << "не найдено \n";
+            else cout << "ошибка \n";
         }
+        cout << "Обработано: " << done << " из " << outcomes.size() << "\n";
     }
-    void change_reservation(int id) {
+    void change_reservation(const vector<int>& ids) {
         Ui::separator();
-        cout << "\n1. Принять оплату \n2. Отменить бронирование \n0. Назад \n";
+        cout << "Выбрано бронирований: " << ids.size() << "\n1. Принять оплату \n2. Отменить бронирование \n0. Назад \n";
 
         int choice = Validator::get_valid_choice(0, 2);
-        switch (choice) {
-        case 0: return;
-        case 1:
-            db.get_payment(id);
-            break;
-        case 2:
-            db.delete_reservation(id);
+        if (choice == 0) return;
+
+        BulkOperation operation = choice == 1 ? CONFIRM_PAYMENT : CANCEL_RESERVATION;
+        if (ids.size() == 1) {
+            if (operation == CONFIRM_PAYMENT) db.get_payment(ids[0]);
+            else db.delete_reservation(ids[0]);
             return;
         }
+        print_bulk_outcomes(db.bulk_update(ids, operation));
     }
     void manage_bookings() {
         while (true) {
@@ -852,10 +2714,51 @@ class AdminSystem : public BookingSystem {
                 continue;
             }
 
-            int chosen_num = find_reservation_id(reservations_result);
-            if (chosen_num == 0) continue;
+            vector<int> chosen_ids = find_reservation_ids(reservations_result);
+            if (chosen_ids.empty()) continue;
+
+            change_reservation(chosen_ids);
+        }
+    }
+    void bulk_process() {
+        while (true) {
+            Ui::separator();
+            cout << "Массовые операции: \n1. Все бронирования гостя \n2. Все бронирования за период \n0. Назад \n";
+            int choice = Validator::get_valid_choice(0, 2);
+
+            BookingPredicate predicate;
+            switch (choice) {
+            case 0: return;
+            case 1: {
+                Ui::separator();
+                cout << "Введите логин гостя: ";
+                string login;
+                cin >> login;
+                predicate.user_id = db.get_user_id(login);
+                if (predicate.user_id == nullopt) {
+                    cout << "Гость не найден! \n";
+                    continue;
+                }
+                break;
+            }
+            case 2:
+                predicate.dates = build_report();
+                if (predicate.dates == nullopt) continue;
+                break;
+            }
+
+            size_t found = db.find_booking_ids(predicate).size();
+            if (found == 0) {
+                cout << "Бронирования не найдены! \n";
+                continue;
+            }
+
+            Ui::separator();
+            cout << "Найдено бронирований: " << found << "\n1. Принять оплату \n2. Отменить бронирования \n0. Назад \n";
+            int operation = Validator::get_valid_choice(0, 2);
+            if (operation == 0) continue;
 
-            change_reservation(chosen_num);
+            print_bulk_outcomes(db.bulk_update(predicate, operation == 1 ? CONFIRM_PAYMENT : CANCEL_RESERVATION));
         }
     }
     optional<Filter> build_report() {
@@ -885,11 +2788,151 @@ class AdminSystem : public BookingSystem {
             }
         }
     }
+    void print_report(const vector<ReportResult>& results) {
+        for (const auto& result : results) {
+            Ui::separator();
+            cout << "Отчёт: " << result.range.in << " - " << result.range.out << "\n";
+            for (const auto& row : result.rows)
+                cout << fixed << setprecision(2) << "Статус: " << row.status << " | Всего бронирований: " << row.count << " | Сумма: " << row.amount << " руб. \n";
+            if (result.rows.empty()) cout << "Нет данных за указанный период.\n";
+        }
+    }
+    int input_report_year() {
+        Ui::separator();
+        cout << "Введите год: ";
+        return Validator::get_valid_choice(2001, 2099);
+    }
+    optional<int> choose_report_job() {
+        vector<int> ids = reports.get_job_ids();
+        if (ids.empty()) {
+            cout << "Нет заданий! \n";
+            return nullopt;
+        }
+
+        const char* states[] = { "в очереди", "выполняется", "готово", "отменено", "ошибка" };
+        Ui::separator();
+        for (int i = 0; i < ids.size(); i++) {
+            auto state = reports.progress(ids[i]);
+            if (state == nullopt) continue;
+            cout << i + 1 << ". Задание #" << ids[i] << " | " << states[state->state] << " | " << state->completed << " из " << state->total << "\n";
+        }
+        cout << "Выберите задание (0 — назад): ";
+        int choice = Validator::get_valid_choice(0, ids.size());
+        if (choice == 0) return nullopt;
+        return ids[choice - 1];
+    }
+    void reports_process() {
+        while (true) {
+            Ui::separator();
+            cout << "Отчёты: \n1. Отчёт по датам \n2. Отчёт по месяцам года \n3. Получить результат \n4. Отменить задание \n0. Назад \n";
+            int choice = Validator::get_valid_choice(0, 4);
+
+            switch (choice) {
+            case 0: return;
+            case 1: {
+                auto report_filter = build_report();
+                if (report_filter) cout << "Задание #" << reports.submit(report_filter.value()) << " поставлено в очередь. \n";
+                break;
+            }
+            case 2: {
+                int id = reports.submit_year(input_report_year());
+                cout << "Задание #" << id << " поставлено в очередь. \n";
+                break;
+            }
+            case 3: {
+                auto id = choose_report_job();
+                if (id == nullopt) break;
+                auto state = reports.progress(id.value());
+                if (state->completed != state->total) {
+                    cout << "Отчёт ещё не готов: " << state->completed << " из " << state->total << "\n";
+                    break;
+                }
+                auto results = reports.collect(id.value());
+                if (results) print_report(results.value());
+                else cout << "Отчёт не был построен! \n";
+                break;
+            }
+            case 4: {
+                auto id = choose_report_job();
+                if (id) reports.cancel(id.value());
+                break;
+            }
+            }
+        }
+    }
+    void print_analytics(const AnalyticsReport& report) {
+        Ui::separator();
+        cout << "Аналитика: " << date::to_str(date::from_days(report.filter.from)) << " - " << date::to_str(date::from_days(report.filter.to))
+            << (report.filter.paid_only ? " | Только оплаченные" : "") << "\n" << fixed << setprecision(1);
+
+        RevenueCell total{};
+        cout << "\nПо категориям: \n";
+        for (size_t type = 0; type < report.types.size(); type++) {
+            RevenueCell cell = analytics::by_type(report, type);
+            analytics::add(total, cell);
+            cout << report.types[type] << " | Загрузка: " << analytics::occupancy(cell) << "% | ADR: " << analytics::adr(cell)
+                << " руб. | RevPAR: " << analytics::revpar(cell) << " руб. | Продано ночей: " << cell.sold << " из " << cell.available << "\n";
+        }
+        cout << "Итого | Загрузка: " << analytics::occupancy(total) << "% | ADR: " << analytics::adr(total) << " руб. | RevPAR: " << analytics::revpar(total)
+            << " руб. | Выручка: " << total.revenue << " руб. \n";
+
+        cout << "\nПо дням недели: \n";
+        for (int day = 0; day < 7; day++) {
+            RevenueCell cell = analytics::by_weekday(report, day);
+            cout << analytics::WEEKDAYS[day] << " | Загрузка: " << analytics::occupancy(cell) << "% | ADR: " << analytics::adr(cell) << " руб. | RevPAR: " << analytics::revpar(cell) << " руб. \n";
+        }
+
+        cout << "\nГлубина бронирования (дней): ";
+        for (size_t i = 0; i < report.lead_time.size(); i++) cout << analytics::LEAD_TIME_LABELS[i] << ": " << report.lead_time[i] << (i + 1 < report.lead_time.size() ? " | " : "\n");
+        cout << "Длительность проживания (ночей): ";
+        for (size_t i = 0; i < report.length_of_stay.size(); i++) cout << analytics::LENGTH_OF_STAY_LABELS[i] << ": " << report.length_of_stay[i] << (i + 1 < report.length_of_stay.size() ? " | " : "\n");
+    }
+    void analytics_process() {
+        auto period = build_report();
+        if (period == nullopt) return;
+        cout << "Учитывать только оплаченные бронирования? (1 - Да / 0 - Нет): ";
+        bool paid_only = Validator::get_valid_choice(0, 1);
+
+        if (!analytics.load()) {
+            cerr << "Ошибка загрузки данных для аналитики! \n";
+            return;
+        }
+        AnalyticsReport report = analytics.analyze({ date::to_days(period->in).value(), date::to_days(period->out).value(), paid_only });
+        print_analytics(report);
+
+        cout << "Сохранить отчёт в CSV? (1 - Да / 0 - Нет): ";
+        if (!Validator::get_valid_choice(0, 1)) return;
+        string path = "analytics_" + period->in + "_" + period->out + ".csv";
+        ofstream file(path);
+        analytics::write_csv(report, file);
+        if (file) cout << "Отчёт сохранён: " << path << "\n";
+        else cerr << "Ошибка записи файла: " << path << "\n";
+    }
+    void print_storage_stats() {
+        StorageStats stats = db.get_storage_stats();
+        const StorageProfile& profile = db.get_storage_profile();
+        int lookups = stats.cache_hits + stats.cache_misses;
+        const char* vacuum_modes[] = { "NONE", "FULL", "INCREMENTAL" };
+
+        Ui::separator();
+        cout << "Профиль хранилища: " << stats.profile << " | synchronous: " << profile.synchronous << " | temp_store: " << profile.temp_store << "\n"
+            << "Кэш страниц: " << profile.cache_size_kb << " КБ | mmap: " << profile.mmap_size / 1048576 << " МБ | Занято кэшем: " << stats.cache_used / 1024 << " КБ\n"
+            << "Попадания в кэш: " << stats.cache_hits << " | Промахи: " << stats.cache_misses
+            << " | Доля попаданий: " << fixed << setprecision(1) << (lookups ? 100.0 * stats.cache_hits / lookups : 0.0) << "% \n"
+            << "auto_vacuum: " << (stats.auto_vacuum >= 0 && stats.auto_vacuum <= 2 ? vacuum_modes[stats.auto_vacuum] : "?")
+            << " | Свободных страниц: " << stats.free_pages << "\n";
+
+        SearchCacheStats searches = db.get_search_stats();
+        long long searches_total = searches.hits + searches.misses;
+        cout << "Кэш поиска: записей " << searches.entries << " | Попадания: " << searches.hits << " | Промахи: " << searches.misses
+            << " | Доля попаданий: " << (searches_total ? 100.0 * searches.hits / searches_total : 0.0) << "% \n"
+            << "Инвалидации: " << searches.invalidations << " | Вытеснения: " << searches.evictions << "\n";
+    }
     void admin_process() {
         while (true) {
             Ui::welcome(user->get_name(), user->get_surname());
-            cout << "1. Зарегестрировать гостя \n2. Управлять бронированиями \n3. Отчёт по датам \n4. Обзор бронирований \n0. Выйти из профиля \n";
-            int choice = Validator::get_valid_choice(0, 4);
+            cout << "1. Зарегестрировать гостя \n2. Управлять бронированиями \n3. Отчёт по датам \n4. Обзор бронирований \n5. Гибкий поиск по датам \n6. Массовые операции \n7. Состояние хранилища \n8. Аналитика доходности \n0. Выйти из профиля \n";
+            int choice = Validator::get_valid_choice(0, 8);
 
             switch (choice) {
             case 0: return;
@@ -899,14 +2942,24 @@ class AdminSystem : public BookingSystem {
             case 2:
                 manage_bookings();
                 break;
-            case 3: {
-                auto report_filter = build_report();
-                if (report_filter) db.get_report_by_dates(report_filter);
+            case 3:
+                reports_process();
                 break;
-            }
             case 4:
                 reservations();
                 break;
+            case 5:
+                flexible_reservation_process(nullopt);
+                break;
+            case 6:
+                bulk_process();
+                break;
+            case 7:
+                print_storage_stats();
+                break;
+            case 8:
+                analytics_process();
+                break;
             }
         }
     }
@@ -915,13 +2968,18 @@ public:
     void start() { admin_process(); }
 };
 
-int main() {
+int main(int argc, char* argv[]) {
     SetConsoleOutputCP(CP_UTF8);
     SetConsoleCP(CP_UTF8);
 
-    Database db("db/base.db");
+    StorageProfile storage = load_storage_profile(argc, argv);
+    Database db("db/base.db", storage);
+    StorageMaintenance maintenance(db.get_path(), storage);
+    AvailabilityIndex availability(db, "db/availability.snap");
+    SnapshotWriter snapshot_writer(db.get_path(), availability, "db/availability.snap", chrono::minutes(10));
     
     while (true) {
+        db.poll_changes();
         AuthManager auth(db);
         cout << "=== СИСТЕМА УПРАВЛЕНИЯ БРОНИРОВАНИЯ МЕСТ В ГОСТИНИЦЕ === \n1. Авторизация \n2. Регистрация \n0. Выйти из системы \n";
 
@@ -939,11 +2997,11 @@ int main() {
 
         if (auto user = db.get_user_by_id(auth.get_user_id())) {
             if (user->get_role() == "admin") {
-                AdminSystem system(db, user.value());
+                AdminSystem system(db, availability, user.value());
                 system.start();
             }
             else {
-                BookingSystem system(db, user.value());
+                BookingSystem system(db, availability, user.value());
                 system.start();
             }
         }
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <climits>
+#include <cstddef>
+#include <string_view>
+
+struct Date { int day, month, year; };
+
+namespace date {
+    inline bool is_year_leap(int year) { return (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0); }
+}
+
+enum ParseError { PARSE_OK, PARSE_EMPTY, PARSE_FORMAT, PARSE_OVERFLOW, PARSE_YEAR_RANGE, PARSE_DAY_RANGE };
+
+template <typename T>
+struct Parsed {
+    T value{};
+    ParseError error = PARSE_OK;
+    explicit operator bool() const { return error == PARSE_OK; }
+};
+
+namespace parse {
+    constexpr bool is_digit(char c) { return c >= '0' && c <= '9'; }
+    constexpr bool is_word(char c) { return is_digit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'; }
+
+    inline std::size_t scan_digits(std::string_view str, std::size_t pos, int& value, std::size_t max_count) {
+        std::size_t start = pos;
+        value = 0;
+        while (pos < str.size() && pos - start < max_count && is_digit(str[pos])) value = value * 10 + (str[pos++] - '0');
+        return pos - start;
+    }
+    inline std::size_t scan_word(std::string_view str, std::size_t pos) {
+        std::size_t start = pos;
+        while (pos < str.size() && is_word(str[pos])) pos++;
+        return pos - start;
+    }
+
+    inline Parsed<int> integer(std::string_view str) {
+        if (str.empty()) return { 0, PARSE_EMPTY };
+        int value = 0;
+        bool overflow = false;
+        for (char c : str) {
+            if (!is_digit(c)) return { 0, PARSE_FORMAT };
+            if (value > (INT_MAX - (c - '0')) / 10) overflow = true;
+            else value = value * 10 + (c - '0');
+        }
+        if (overflow) return { 0, PARSE_OVERFLOW };
+        return { value };
+    }
+    inline Parsed<Date> date(std::string_view str) {
+        if (str.empty()) return { {}, PARSE_EMPTY };
+        int year = 0, month = 0, day = 0;
+        std::size_t pos = scan_digits(str, 0, year, 4);
+        if (pos != 4 || pos == str.size() || is_digit(str[pos])) return { {}, PARSE_FORMAT };
+
+        std::size_t length = scan_digits(str, ++pos, month, 2);
+        if (!length || month < 1 || month > 12 || pos + length == str.size() || is_digit(str[pos + length])) return { {}, PARSE_FORMAT };
+        pos += length + 1;
+
+        length = scan_digits(str, pos, day, 2);
+        if (!length || day < 1 || day > 31 || pos + length != str.size()) return { {}, PARSE_FORMAT };
+
+        if (year < 2001 || year > 2099) return { {}, PARSE_YEAR_RANGE };
+        static const int days_in_month[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+        if (day > days_in_month[month - 1] + (month == 2 && ::date::is_year_leap(year))) return { {}, PARSE_DAY_RANGE };
+        return { Date{ day, month, year } };
+    }
+    inline ParseError name(std::string_view str) {
+        if (str.empty()) return PARSE_EMPTY;
+        for (char c : str) if (is_digit(c)) return PARSE_FORMAT;
+        return PARSE_OK;
+    }
+    inline ParseError phone(std::string_view str) {
+        std::size_t pos = !str.empty() && str[0] == '+';
+        if (pos == str.size()) return PARSE_EMPTY;
+        for (; pos < str.size(); pos++) if (!is_digit(str[pos])) return PARSE_FORMAT;
+        return PARSE_OK;
+    }
+    inline ParseError email(std::string_view str) {
+        if (str.empty()) return PARSE_EMPTY;
+        std::size_t local = scan_word(str, 0);
+        if (!local || local == str.size() || str[local] != '@') return PARSE_FORMAT;
+        std::size_t domain = scan_word(str, local + 1);
+        std::size_t dot = local + 1 + domain;
+        if (!domain || dot == str.size() || str[dot] != '.') return PARSE_FORMAT;
+        std::size_t zone = scan_word(str, dot + 1);
+        return zone && dot + 1 + zone == str.size() ? PARSE_OK : PARSE_FORMAT;
+    }
+    inline const char* describe(ParseError error) {
+        switch (error) {
+        case PARSE_YEAR_RANGE: return "Дата должна быть в диапазоне 2001 - 2099! \n";
+        case PARSE_DAY_RANGE: return "Вы вышли за пределы месяца! \n";
+        default: return "Ошибка ввода! \n";
+        }
+    }
+}
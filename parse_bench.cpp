@@ -0,0 +1,48 @@
+// Microbenchmark of Parse.h against the std::regex validation it replaced.
+// g++ -std=c++17 -O2 parse_bench.cpp -o parse_bench && ./parse_bench [iterations]
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <regex>
+#include <chrono>
+#include <functional>
+#include "Parse.h"
+
+using namespace std;
+
+volatile long long sink = 0;
+
+void measure(const string& name, const vector<string>& inputs, long long iterations, const function<bool(const string&)>& check) {
+    auto start = chrono::steady_clock::now();
+    long long accepted = 0;
+    for (long long i = 0; i < iterations; i++) accepted += check(inputs[i % inputs.size()]);
+    double elapsed = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+    sink += accepted;
+    cout << fixed << setprecision(1) << setw(10) << elapsed / iterations << " нс/вызов | " << name << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    long long iterations = argc > 1 ? stoll(argv[1]) : 20000;
+
+    vector<string> dates = { "2026-10-18", "2030-2-29", "2028-02-29", "1999-01-01", "2026-13-01", "20261018", "2026/1/5" };
+    vector<string> integers = { "0", "7", "42", "2030", "99999999999", "12a", "" };
+    vector<string> names = { "Иван", "Petrov", "Anna-Maria", "R2D2" };
+    vector<string> phones = { "+79001234567", "89001234567", "+7(900)", "+" };
+    vector<string> emails = { "ivan@mail.ru", "a_b@host.com", "no-at.example", "x@y" };
+
+    static const regex date_regex(R"(^(\d{4})\D([1-9]|0[1-9]|1[0-2])\D([1-9]|0[1-9]|[12][0-9]|3[01])$)");
+    static const regex int_regex(R"(^\d+$)");
+
+    measure("regex: дата", dates, iterations, [](const string& s) { smatch m; return regex_match(s, m, date_regex); });
+    measure("parse::date", dates, iterations, [](const string& s) { return static_cast<bool>(parse::date(s)); });
+    measure("regex: число", integers, iterations, [](const string& s) { return regex_match(s, int_regex); });
+    measure("parse::integer", integers, iterations, [](const string& s) { return static_cast<bool>(parse::integer(s)); });
+    measure("regex: имя", names, iterations, [](const string& s) { return regex_match(s, regex("\\D+")); });
+    measure("parse::name", names, iterations, [](const string& s) { return parse::name(s) == PARSE_OK; });
+    measure("regex: телефон", phones, iterations, [](const string& s) { return regex_match(s, regex("\\+?[0-9]+")); });
+    measure("parse::phone", phones, iterations, [](const string& s) { return parse::phone(s) == PARSE_OK; });
+    measure("regex: email", emails, iterations, [](const string& s) { return regex_match(s, regex("\\w+[@]\\w+[.]\\w+")); });
+    measure("parse::email", emails, iterations, [](const string& s) { return parse::email(s) == PARSE_OK; });
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Differential fuzz test of Parse.h against the std::regex validation it replaced.
+// g++ -std=c++17 -O2 parse_fuzz.cpp -o parse_fuzz && ./parse_fuzz [iterations] [seed]
+#include <iostream>
+#include <string>
+#include <regex>
+#include <random>
+#include "Parse.h"
+
+using namespace std;
+
+const regex date_regex(R"(^(\d{4})\D([1-9]|0[1-9]|1[0-2])\D([1-9]|0[1-9]|[12][0-9]|3[01])$)");
+const regex int_regex(R"(^\d+$)");
+const regex name_regex("\\D+");
+const regex phone_regex("\\+?[0-9]+");
+const regex email_regex("\\w+[@]\\w+[.]\\w+");
+
+bool check_date(const string& input) {
+    smatch matched;
+    auto parsed = parse::date(input);
+    if (!regex_match(input, matched, date_regex)) return parsed.error == PARSE_FORMAT || parsed.error == PARSE_EMPTY;
+
+    int year = stoi(matched[1]), month = stoi(matched[2]), day = stoi(matched[3]);
+    if (year < 2001 || year > 2099) return parsed.error == PARSE_YEAR_RANGE;
+
+    int days_in_month[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    if ((year % 4 == 0 && year % 100 != 0) || year % 400 == 0) days_in_month[1] = 29;
+    if (day > days_in_month[month - 1]) return parsed.error == PARSE_DAY_RANGE;
+
+    return parsed && parsed.value.year == year && parsed.value.month == month && parsed.value.day == day;
+}
+bool check_integer(const string& input) {
+    auto parsed = parse::integer(input);
+    if (!regex_match(input, int_regex)) return parsed.error == PARSE_FORMAT || parsed.error == PARSE_EMPTY;
+
+    size_t first = input.find_first_not_of('0');
+    string digits = first == string::npos ? "0" : input.substr(first);
+    bool fits = digits.size() < 10 || (digits.size() == 10 && digits <= to_string(INT_MAX));
+    if (!fits) return parsed.error == PARSE_OVERFLOW;
+    return parsed && parsed.value == stoi(digits);
+}
+bool check_text(const string& input) {
+    return regex_match(input, name_regex) == (parse::name(input) == PARSE_OK)
+        && regex_match(input, phone_regex) == (parse::phone(input) == PARSE_OK)
+        && regex_match(input, email_regex) == (parse::email(input) == PARSE_OK);
+}
+
+string random_input(mt19937& rng) {
+    static const string alphabet = "0123456789-/. +@_azAZ\t\xd0\xb0";
+    auto pick = [&](size_t count) { return static_cast<size_t>(rng() % count); };
+    auto digits = [&](size_t count) {
+        string result;
+        for (size_t i = 0; i < count; i++) result += char('0' + pick(10));
+        return result;
+    };
+
+    string input;
+    switch (pick(4)) {
+    case 0:
+        input = digits(1 + pick(5)) + alphabet[pick(alphabet.size())] + digits(pick(4)) + alphabet[pick(alphabet.size())] + digits(pick(4));
+        break;
+    case 1:
+        input = digits(pick(14));
+        break;
+    case 2:
+        input = (pick(2) ? "" : "+") + digits(pick(12));
+        break;
+    default:
+        for (size_t i = pick(16); i > 0; i--) input += alphabet[pick(alphabet.size())];
+    }
+    if (!input.empty() && pick(8) == 0) input[pick(input.size())] = alphabet[pick(alphabet.size())];
+    return input;
+}
+
+int main(int argc, char* argv[]) {
+    long long iterations = argc > 1 ? stoll(argv[1]) : 1000000;
+    mt19937 rng(argc > 2 ? static_cast<unsigned>(stoul(argv[2])) : 2024u);
+
+    long long mismatches = 0;
+    for (long long i = 0; i < iterations; i++) {
+        string input = random_input(rng);
+        if (check_date(input) && check_integer(input) && check_text(input)) continue;
+        if (mismatches++ < 20) cout << "Расхождение: [" << input << "]\n";
+    }
+
+    cout << "Проверено: " << iterations << " | Расхождений: " << mismatches << "\n";
+    return mismatches ? 1 : 0;
+}